@@ -0,0 +1,48 @@
+import os
+import sys
+
+import numpy as np
+from skimage import io
+from tqdm import tqdm
+
+
+def compareGI(refFlPath, tstFlPath):
+  # List the GI images present in both folders
+  flGIList = os.listdir(refFlPath)
+  flGIList = list(filter(lambda x: x.endswith('.png'), flGIList))
+  flGIList = sorted(filter(lambda x: os.path.exists(os.path.join(tstFlPath, x)), flGIList))
+  if not flGIList:
+    print('No common GI found in %s and %s'%(refFlPath, tstFlPath))
+    return
+
+  # Per GI type (flatGI, nflatGI, ...) accumulate the absolute difference in steps of the encoding of
+  # the image, e.g. 1/255 of the range for the 8-bit GIs and one label for the 16-bit label GI
+  stats = {}
+  for gi in tqdm(flGIList):
+    ref = io.imread(os.path.join(refFlPath, gi))
+    tst = io.imread(os.path.join(tstFlPath, gi))
+    if ref.shape != tst.shape or ref.dtype != tst.dtype:
+      print('GI: %s differs in shape or type %s %s vs %s %s'%(gi, ref.shape, ref.dtype, tst.shape, tst.dtype))
+      continue
+    diff = np.abs(ref.astype(np.float64) - tst.astype(np.float64))
+    if not np.issubdtype(ref.dtype, np.integer):
+      diff *= 255
+    giType = gi[gi.rfind('_') + 1:-4]
+    s = stats.setdefault(giType, [0, 0.0, 0.0, 0, 0])
+    s[0] += 1
+    s[1] = max(s[1], diff.max())
+    s[2] += diff.sum()
+    s[3] += np.count_nonzero(diff)
+    s[4] += diff.size
+    stats[giType] = s
+
+  print('%-12s %6s %10s %12s %12s'%('GI', 'files', 'max', 'mean', 'differing'))
+  for giType, (n, maxD, sumD, nDiff, size) in sorted(stats.items()):
+    print('%-12s %6d %10.3f %12.5f %11.3f%%'%(giType, n, maxD, sumD / size, 100.0 * nDiff / size))
+
+
+if __name__ == '__main__':
+  if len(sys.argv) != 3:
+    print('usage: python compareGI.py <GI folder of Main> <GI folder of Main_f32>')
+    sys.exit(1)
+  compareGI(sys.argv[1], sys.argv[2])
@@ -85,14 +85,20 @@ def load_GI(path, params, instance):
 
   meanFile = os.path.join(params['model_dir'], 'meanShape.off')
   if params['generateMeanShape'] and instance == 'trn' and not os.path.exists(meanFile):
-    unique_gi_list = list(set(gi_list))
-    unique_gi_np = np.empty([len(unique_gi_list), params['gi_size'], params['gi_size'], params['gi_channels']])
-    print('Loading unique gi files')
-    for i in tqdm(range(len(unique_gi_list))):
-      im = np.array(skimage.io.imread(unique_gi_list[i][0]))
-      im = skimage.img_as_float32(im)
-      unique_gi_np[i, :, :, 0:3] = skimage.transform.resize(im, [params['gi_size'], params['gi_size']])
-    mean_unique_gi = np.mean(unique_gi_np, axis=0)
+    if params.get('meanShapeGI'):
+      # mean GI accumulated while the GIs were written (Main --giStats)
+      mean_unique_gi = np.zeros([params['gi_size'], params['gi_size'], params['gi_channels']])
+      im = skimage.img_as_float32(np.array(skimage.io.imread(params['meanShapeGI'])))
+      mean_unique_gi[:, :, 0:3] = skimage.transform.resize(im, [params['gi_size'], params['gi_size']])
+    else:
+      unique_gi_list = list(set(gi_list))
+      unique_gi_np = np.empty([len(unique_gi_list), params['gi_size'], params['gi_size'], params['gi_channels']])
+      print('Loading unique gi files')
+      for i in tqdm(range(len(unique_gi_list))):
+        im = np.array(skimage.io.imread(unique_gi_list[i][0]))
+        im = skimage.img_as_float32(im)
+        unique_gi_np[i, :, :, 0:3] = skimage.transform.resize(im, [params['gi_size'], params['gi_size']])
+      mean_unique_gi = np.mean(unique_gi_np, axis=0)
     if not os.path.exists(params['model_dir']):
       os.makedirs(params['model_dir'])
     writeOff(meanFile, mean_unique_gi)
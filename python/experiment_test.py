@@ -14,6 +14,7 @@ params['checkpoint'] = '35424' #14850
 params['rgb_size'] = 128
 params['gi_size'] = 128
 params['tst_dir'] = 'tst_rgb'
+params['npy'] = False # save the predicted GIs as one float batch for ./Main --G2o instead of writing the off files
 
 checkpointPath = os.path.join(params['model_dir'], 'model.ckpt-' + params['checkpoint'])
 
@@ -38,11 +39,18 @@ prediction = predict(model_fn, params, rgb_imgs, checkpointPath)
 reflector = np.array([1,1,-1])
 
 # extract the predictions and save as off file in the same path as the input rgb images
+batch = []
 for i in range(len(rgb_imgs)):
     out = next(prediction)
     if isinstance(out, dict):
         output = postprocess(out['prediction'])
+        if params['npy']:
+            batch.append(output.astype(np.float32))
+            continue
         slice1 = np.reshape(output,[params['gi_size']*params['gi_size'],3])
         slice2 = slice1 * reflector
         utils.writeOff(rgb_imgs[i].replace('.png','.off'), np.concatenate((slice1,slice2),axis=0), params['gi_size'], True)
 
+# GI k of the batch is remeshed to <model>_<k>.off, in the order of rgb_imgs
+if params['npy'] and batch:
+    np.save(os.path.join(params['tst_dir'], params['model'] + '.npy'), np.stack(batch))
@@ -15,6 +15,7 @@ params['gi_channels'] = 3
 params['use_mask'] = True
 params['loadFiles'] = False
 params['generateMeanShape'] = True
+params['meanShapeGI'] = None  # <file>_meanShape.png of Main --giStats, avoids reading all GIs for the mean shape
 params['SelectedViews'] = ['view000', 'view001', 'view002', 'view010', 'view011', 'view012',
                            'view020', 'view021', 'view022', 'view030', 'view031', 'view032',
                            'view040', 'view041', 'view042', 'view050', 'view051', 'view052',
@@ -0,0 +1,216 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Dedup.h"
+#include "MeshStream.h"
+#include "Pack.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+Dedup::Dedup(const std::vector<fs::path>& items, double tol): items(items), tol(tol) {
+}
+
+Dedup::~Dedup() {
+  // TODO Auto-generated destructor stub
+}
+
+void Dedup::run() {
+  // signatures are computed on all cores, the grouping keeps the list order
+  std::vector<signature> sigs(items.size());
+  std::vector<char> ok(items.size(), 0);
+  std::atomic<int> next(0);
+  std::vector<std::thread> threads;
+  int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (int t = 0; t < nThreads; ++t)
+    threads.push_back(std::thread([&] {
+      for (int i = next++; i < (int) items.size(); i = next++)
+        ok[i] = sign(items[i], sigs[i]);
+    }));
+  for (int t = 0; t < nThreads; ++t)
+    threads[t].join();
+
+  std::map<signature, int> first;
+  canonical.assign(items.size(), -1);
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    // an input that can't be read is processed on its own and fails there
+    if (!ok[i]) {
+      canonical[i] = i;
+      continue;
+    }
+    canonical[i] = first.insert(std::make_pair(sigs[i], (int) i)).first->second;
+  }
+}
+
+std::vector<fs::path> Dedup::canonicals() const {
+  std::vector<fs::path> list;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (canonical[i] == (int) i)
+      list.push_back(items[i]);
+  }
+  return list;
+}
+
+std::vector<int> Dedup::groupSizes() const {
+  // number of inputs each entry of canonicals() stands for, itself included
+  std::vector<int> sizes, slot(items.size(), -1);
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (canonical[i] == (int) i) {
+      slot[i] = sizes.size();
+      sizes.push_back(0);
+    }
+    ++sizes[slot[canonical[i]]];
+  }
+  return sizes;
+}
+
+std::size_t Dedup::nDuplicates() const {
+  return items.size() - canonicals().size();
+}
+
+int Dedup::link(fs::path outputPath) const {
+  // every output is named after the stem of its input followed by '.' or '_', a file belongs
+  // to the longest listed stem it starts with
+  std::map<std::string, std::vector<int> > duplicates;  // stem of a canonical input -> its duplicates
+  std::map<std::string, int> stems;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    stems[items[i].stem().string()] = i;
+    if (canonical[i] != (int) i)
+      duplicates[items[canonical[i]].stem().string()].push_back(i);
+  }
+  if (duplicates.empty())
+    return 0;
+
+  std::function<std::string(const std::string&)> ownerOf = [&](const std::string& name) {
+    std::string owner;
+    for (std::size_t pos = name.find_first_of("._"); pos != std::string::npos; pos = name.find_first_of("._", pos + 1)) {
+      if (stems.count(name.substr(0, pos)))
+        owner = name.substr(0, pos);
+    }
+    return owner;
+  };
+
+  // the masks of mesh2GI are in the _msk folder next to the output folder
+  int nLinks = 0;
+  std::string folder = outputPath.string();
+  while (folder.size() > 1 && folder[folder.size() - 1] == '/')
+    folder.erase(folder.size() - 1);
+  fs::path folders[] = { outputPath, fs::path(folder + "_msk") };
+  std::vector<fs::path> files;
+  for (int k = 0; k < 2; ++k) {
+    if (!fs::is_directory(folders[k]))
+      continue;
+    for (fs::directory_iterator it(folders[k]); it != fs::directory_iterator(); ++it) {
+      if (fs::is_regular_file(it->path()))
+        files.push_back(it->path());
+    }
+  }
+  for (std::size_t f = 0; f < files.size(); ++f) {
+    std::string name = files[f].filename().string(), owner = ownerOf(name);
+    std::map<std::string, std::vector<int> >::const_iterator dup = duplicates.find(owner);
+    if (dup == duplicates.end())
+      continue;
+    for (std::size_t d = 0; d < dup->second.size(); ++d) {
+      fs::path linkPath = files[f].parent_path() / (items[dup->second[d]].stem().string() + name.substr(owner.size()));
+      if (fs::exists(fs::symlink_status(linkPath)))
+        continue;
+      boost::system::error_code ec;
+      fs::create_symlink(files[f].filename(), linkPath, ec);
+      if (ec)
+        fs::copy_file(files[f], linkPath, ec);
+      if (!ec)
+        ++nLinks;
+    }
+  }
+
+  // a pack has no links, the records are appended again under the names of the duplicates
+  std::shared_ptr<Pack> P = Pack::reader(outputPath / "pack.lssp");
+  std::vector<std::string> packed = P ? P->names() : std::vector<std::string>();
+  for (std::size_t f = 0; f < packed.size(); ++f) {
+    std::string owner = ownerOf(packed[f]), bytes;
+    std::map<std::string, std::vector<int> >::const_iterator dup = duplicates.find(owner);
+    if (dup == duplicates.end() || !P->get(packed[f], bytes))
+      continue;
+    for (std::size_t d = 0; d < dup->second.size(); ++d) {
+      std::string linkName = items[dup->second[d]].stem().string() + packed[f].substr(owner.size());
+      if (!P->has(linkName) && P->put(linkName, bytes))
+        ++nLinks;
+    }
+  }
+  return nLinks;
+}
+
+
+// private
+bool Dedup::signature::operator<(const signature& o) const {
+  if (nV != o.nV)
+    return nV < o.nV;
+  if (nF != o.nF)
+    return nF < o.nF;
+  for (int k = 0; k < 6; ++k) {
+    if (box[k] != o.box[k])
+      return box[k] < o.box[k];
+  }
+  return hash < o.hash;
+}
+
+bool Dedup::sign(const fs::path& item, signature& sig) const {
+  fs::ifstream in(item);
+  std::size_t nV, nF;
+  if (!in || !MeshStream::readHeader(in, nV, nF))
+    return false;
+  std::vector<double> P(3 * nV);
+  std::string line;
+  for (std::size_t i = 0; i < nV; ++i) {
+    if (!MeshStream::nextLine(in, line))
+      return false;
+    std::istringstream ss(line);
+    if (!(ss >> P[3 * i] >> P[3 * i + 1] >> P[3 * i + 2]))
+      return false;
+  }
+
+  double lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+  for (std::size_t i = 0; i < nV; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      lo[k] = i ? std::min(lo[k], P[3 * i + k]) : P[k];
+      hi[k] = i ? std::max(hi[k], P[3 * i + k]) : P[k];
+    }
+  }
+  double diag = std::sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) + (hi[1] - lo[1]) * (hi[1] - lo[1]) + (hi[2] - lo[2]) * (hi[2] - lo[2]));
+  // the cell follows the diagonal in powers of two, near duplicates then share the grid
+  double cell = diag > 0 ? tol * std::exp2(std::ceil(std::log2(diag))) : 1;
+
+  // quantized positions are sorted, so the hash does not depend on the vertex order
+  std::vector<int64_t> Q(3 * nV);
+  for (std::size_t i = 0; i < 3 * nV; ++i)
+    Q[i] = (int64_t) std::llround(P[i] / cell);
+  std::vector<std::size_t> order(nV);
+  for (std::size_t i = 0; i < nV; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return std::lexicographical_compare(&Q[3 * a], &Q[3 * a] + 3, &Q[3 * b], &Q[3 * b] + 3);
+  });
+  // FNV-1a over the bytes of the sorted positions
+  uint64_t hash = 1469598103934665603ULL;
+  for (std::size_t i = 0; i < nV; ++i) {
+    const unsigned char* bytes = (const unsigned char*) &Q[3 * order[i]];
+    for (std::size_t b = 0; b < 3 * sizeof(int64_t); ++b)
+      hash = (hash ^ bytes[b]) * 1099511628211ULL;
+  }
+
+  sig.nV = nV;
+  sig.nF = nF;
+  for (int k = 0; k < 3; ++k) {
+    sig.box[k] = (int64_t) std::llround(lo[k] / cell);
+    sig.box[3 + k] = (int64_t) std::llround(hi[k] / cell);
+  }
+  sig.hash = hash;
+  return true;
+}
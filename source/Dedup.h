@@ -0,0 +1,50 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef DEDUP_H_
+#define DEDUP_H_
+
+#include "include.h"
+
+#include <map>
+
+// Finds inputs of the list with the same geometry before processing. The signature of a mesh
+// is its vertex and face count, its bounding box and a hash of the sorted vertex positions,
+// all quantized to cells of about tol times the bounding box diagonal. The match is exact
+// after quantization: copies differing by rounding match as long as every coordinate rounds
+// to the same cell, a coordinate on either side of a cell boundary, or diagonals on either
+// side of a power of two, make two near duplicates differ. Only the first input of each
+// signature is processed, the outputs written for it are afterwards linked under the names of
+// its duplicates.
+class Dedup {
+public:
+  Dedup(const std::vector<fs::path>& items, double tol);
+  virtual ~Dedup();
+  void run();
+  std::vector<fs::path> canonicals() const;
+  std::vector<int> groupSizes() const;
+  std::size_t nDuplicates() const;
+  int link(fs::path outputPath) const;
+
+private:
+  struct signature {
+    uint64_t nV, nF;
+    int64_t box[6];
+    uint64_t hash;
+    bool operator<(const signature& o) const;
+  };
+
+  bool sign(const fs::path& item, signature& sig) const;
+
+  const std::vector<fs::path>& items;
+  double tol;
+  std::vector<int> canonical;  // index of the processed input with the same signature, -1 if unreadable
+};
+
+#endif /* DEDUP_H_ */
@@ -0,0 +1,389 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef GIGENERATOR_H_
+#define GIGENERATOR_H_
+
+#include "include.h"
+#include "UVGrid.h"
+
+#include <tuple>
+#include <type_traits>
+#include <CGAL/IO/Color.h>
+#include <CGAL/Polygon_mesh_processing/compute_normal.h>
+typedef Surface_mesh::Property_map<vertex_descriptor, Kernel::Vector_3> SM_nmap;
+
+// how the accumulated channels of an attribute are turned into the saved image
+enum GIEncoding {
+  GI_GEOMETRY,  // shared offset and uniform scale over all channels, as for the position GI
+  GI_RANGE, // every channel min-max normalized on its own
+  GI_RAW, // values are already in 0-255
+  GI_LABEL  // integer labels, not hole filled, saved as 16 bit
+};
+
+// channels of one attribute inside the accumulation buffers of a GIGenerator
+struct GIChannels {
+  std::string name; // GI file suffix
+  int offset;
+  int channels;
+  GIEncoding encoding;
+};
+
+// Per-vertex attributes which can be sampled into a geometry image. Each provides its
+// number of channels, whether it is interpolated (hard = 0) or taken from the nearest
+// corner (hard = 1), its file suffix and encoding, and fetch() for one vertex. A hard
+// attribute is written once per pixel by the first face covering it instead of being
+// summed, so that its samples are never averaged into values of neither face.
+
+struct GIPosition {
+  enum { channels = 3, hard = 0 };
+  static const char* name() { return "flatGI"; }
+  static GIEncoding encoding() { return GI_GEOMETRY; }
+  bool prepare(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    this->sm = &sm;
+    return true;
+  }
+  void fetch(vertex_descriptor vd, float* out) const {
+    const Point_3& pt = sm->point(vd);
+    out[0] = pt.x();
+    out[1] = pt.y();
+    out[2] = pt.z();
+  }
+  Surface_mesh* sm;
+};
+
+struct GINormal {
+  enum { channels = 3, hard = 0 };
+  static const char* name() { return "nflatGI"; }
+  static GIEncoding encoding() { return GI_GEOMETRY; }
+  bool prepare(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    nm = sm.add_property_map<vertex_descriptor, Kernel::Vector_3>("v:normals", CGAL::NULL_VECTOR).first;
+    CGAL::Polygon_mesh_processing::compute_vertex_normals(sm, nm);
+    return true;
+  }
+  void fetch(vertex_descriptor vd, float* out) const {
+    const Kernel::Vector_3& n = nm[vd];
+    out[0] = n.x();
+    out[1] = n.y();
+    out[2] = n.z();
+  }
+  SM_nmap nm;
+};
+
+struct GICurvature {
+  enum { channels = 1, hard = 0 };
+  static const char* name() { return "cflatGI"; }
+  static GIEncoding encoding() { return GI_RANGE; }
+  bool prepare(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    // mean curvature estimate from the umbrella operator projected on the vertex normal,
+    // scaled by the mean edge length around the vertex so that it does not depend on the mesh size
+    SM_nmap nm = sm.add_property_map<vertex_descriptor, Kernel::Vector_3>("v:normals", CGAL::NULL_VECTOR).first;
+    CGAL::Polygon_mesh_processing::compute_vertex_normals(sm, nm);
+    cm = sm.add_property_map<vertex_descriptor, float>("v:curvature", 0).first;
+    BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+      Kernel::Vector_3 umbrella = CGAL::NULL_VECTOR;
+      double edgeLength = 0;
+      int valence = 0;
+      BOOST_FOREACH(vertex_descriptor vn, vertices_around_target(sm.halfedge(vd), sm)) {
+        Kernel::Vector_3 e = sm.point(vn) - sm.point(vd);
+        umbrella = umbrella + e;
+        edgeLength += std::sqrt(e.squared_length());
+        valence++;
+      }
+      if (valence == 0 || edgeLength == 0)
+        continue;
+      umbrella = umbrella / valence;
+      edgeLength /= valence;
+      cm[vd] = (umbrella * nm[vd]) / (edgeLength * edgeLength);
+    }
+    return true;
+  }
+  void fetch(vertex_descriptor vd, float* out) const {
+    out[0] = cm[vd];
+  }
+  Surface_mesh::Property_map<vertex_descriptor, float> cm;
+};
+
+struct GIColor {
+  enum { channels = 3, hard = 0 };
+  static const char* name() { return "rgbflatGI"; }
+  static GIEncoding encoding() { return GI_RAW; }
+  bool prepare(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    // vertex colors are read by the OFF reader from a COFF input
+    std::pair<Surface_mesh::Property_map<vertex_descriptor, CGAL::Color>, bool> found =
+        sm.property_map<vertex_descriptor, CGAL::Color>("v:color");
+    if (!found.second) {
+      std::cerr << "  No vertex colors in 3D mesh" << std::endl;
+      LogFile << "No vertex colors in 3D mesh" << std::endl;
+      return false;
+    }
+    color = found.first;
+    return true;
+  }
+  void fetch(vertex_descriptor vd, float* out) const {
+    const CGAL::Color& c = color[vd];
+    out[0] = c.red();
+    out[1] = c.green();
+    out[2] = c.blue();
+  }
+  Surface_mesh::Property_map<vertex_descriptor, CGAL::Color> color;
+};
+
+struct GILabel {
+  enum { channels = 1, hard = 1 };
+  static const char* name() { return "lflatGI"; }
+  static GIEncoding encoding() { return GI_LABEL; }
+  bool prepare(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    // segmentation labels are read from a .seg file next to the input, one label per vertex
+    fs::path segPath = inputPath;
+    segPath.replace_extension(".seg");
+    fs::ifstream seg_fs(segPath);
+    if (!seg_fs) {
+      std::cerr << "  No " << segPath << " for label GI" << std::endl;
+      LogFile << "No " << segPath << " for label GI" << std::endl;
+      return false;
+    }
+    lm = sm.add_property_map<vertex_descriptor, float>("v:label", 0).first;
+    BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+      int label;
+      if (!(seg_fs >> label)) {
+        std::cerr << "  Fewer labels than vertices in " << segPath << std::endl;
+        LogFile << "Fewer labels than vertices in " << segPath << std::endl;
+        return false;
+      }
+      lm[vd] = label;
+    }
+    return true;
+  }
+  void fetch(vertex_descriptor vd, float* out) const {
+    out[0] = lm[vd];
+  }
+  Surface_mesh::Property_map<vertex_descriptor, float> lm;
+};
+
+template <typename... Attrs> struct GIChannelCount;
+template <> struct GIChannelCount<> {
+  enum { value = 0 };
+};
+template <typename Head, typename... Tail> struct GIChannelCount<Head, Tail...> {
+  enum { value = Head::channels + GIChannelCount<Tail...>::value };
+};
+
+// Calls visit(r_idx, c_idx, c) for every pixel inside the image covered by the face with the
+// pixel space corners P, c being the barycentric coords of the pixel in the face
+template <typename Visit>
+void coverFace(const float (*P)[3], int im_size, Visit visit) {
+  // Dimensions of the mesh grid
+  int r_min = (int) std::floor(std::min(std::min(P[0][0], P[0][1]), P[0][2]));
+  int c_min = (int) std::floor(std::min(std::min(P[1][0], P[1][1]), P[1][2]));
+  int n_rows = (int) std::ceil(std::max(std::max(P[0][0], P[0][1]), P[0][2])) - r_min + 1;
+  int n_cols = (int) std::ceil(std::max(std::max(P[1][0], P[1][1]), P[1][2])) - c_min + 1;
+  if(n_rows<= 0 ||n_cols<= 0)
+    return;
+
+  // barycentric coords are solved in closed form for every grid position of the face
+  float e1r = P[0][1] - P[0][0], e1c = P[1][1] - P[1][0];
+  float e2r = P[0][2] - P[0][0], e2c = P[1][2] - P[1][0];
+  float det = e1r * e2c - e2r * e1c;
+  // a degenerate face has no solution and does not contribute
+  if (det == 0)
+    return;
+
+  for (int j = 0; j < n_cols; ++j) {
+    int c_idx = c_min + j;
+    for (int i = 0; i < n_rows; ++i) {
+      int r_idx = r_min + i;
+      float dr = r_idx - P[0][0], dc = c_idx - P[1][0];
+      float c[3];
+      c[1] = (dr * e2c - e2r * dc) / det;
+      c[2] = (e1r * dc - dr * e1c) / det;
+      c[0] = 1 - c[1] - c[2];
+
+      // restrict the BC to inside triangle
+      // cutoff was previously taken from octave but should be different for c++ beacuse of difference in datatypes
+      if (!(c[0] >= -0.000022204 && c[1] >= -0.000022204 && c[2] >= -0.000022204))
+        continue;
+      // restrict the pos to inside the image
+      if (r_idx < 0 || r_idx >= im_size || c_idx < 0 || c_idx >= im_size)
+        continue;
+      visit(r_idx, c_idx, c);
+    }
+  }
+}
+
+// Samples all attributes of the compile-time list Attrs in a single pass over the
+// parameterization. The per-pixel loops are unrolled per attribute, so they carry no
+// runtime switches; buffers are laid out attribute after attribute.
+template <typename... Attrs>
+class GIGenerator {
+public:
+  enum { channels = GIChannelCount<Attrs...>::value };
+  typedef std::tuple<Attrs...> attr_tuple;
+  static_assert(sizeof...(Attrs) > 0, "GIGenerator needs at least one attribute");
+
+  bool prepare(Surface_mesh& Mesh_3D, const fs::path& inputPath, std::stringstream& LogFile) {
+    return prepareAll<0>(Mesh_3D, inputPath, LogFile);
+  }
+
+  void layout(std::vector<GIChannels>& out) const {
+    out.clear();
+    layoutAll<0>(out, 0);
+  }
+
+  // every face adds its interpolation to all pixels it covers, the sum is later averaged by Mnb
+  // (hard attributes keep the sample of the first face)
+  void scatter(Surface_mesh& Mesh_2D, int im_size, cv::Mat* acc, cv::Mat& Mnb) const {
+    float P[2][3];  // Current 2D point
+    float V[3][channels]; // attribute values at the corners
+    BOOST_FOREACH(face_descriptor fd, Mesh_2D.faces()) {
+      int vt_count = 0;
+      BOOST_FOREACH(vertex_descriptor vd_2D, vertices_around_face(Mesh_2D.halfedge(fd), Mesh_2D)) {
+        P[0][vt_count] = Mesh_2D.point(vd_2D)[0] * (im_size - 1);
+        P[1][vt_count] = Mesh_2D.point(vd_2D)[1] * (im_size - 1);
+        // the 3D mesh vertex has the same descriptor as the 2D one
+        fetchAll<0>(vd_2D, V[vt_count]);
+        vt_count++;
+      }
+      rasterize(P, V, im_size, acc, Mnb);
+    } // for all faces
+  }
+
+  // adds the interpolation of the corner values V at the pixel space corners P to all pixels
+  // the face covers, shared by scatter and the streamed rasterization of packed meshes
+  void rasterize(const float (*P)[3], const float (*V)[channels], int im_size, cv::Mat* acc, cv::Mat& Mnb) const {
+    coverFace(P, im_size, [&](int r_idx, int c_idx, const float* c) {
+      float h[3];
+      nearestCorner(c, h);
+      float& nb = Mnb.at<float>(r_idx, c_idx);
+      accumulateAll<0, true>(V, c, h, acc, r_idx, c_idx, nb == 0);
+      nb += 1;
+    });
+  }
+
+  // adds (or sets) the interpolation at barycentric coords c of the face with corners vd to a pixel,
+  // first tells if it is the first sample of the pixel
+  template <bool add>
+  void sample(const vertex_descriptor* vd, const float* c, cv::Mat* acc, int r_idx, int c_idx, bool first = true) const {
+    float V[3][channels];
+    float h[3];
+    for (int k = 0; k < 3; ++k)
+      fetchAll<0>(vd[k], V[k]);
+    nearestCorner(c, h);
+    accumulateAll<0, add>(V, c, h, acc, r_idx, c_idx, first);
+  }
+
+  // every pixel of the rows first, first+step, ... takes the value of the one face containing it
+  void gather(const UVGrid& grid, int im_size, cv::Mat* acc, cv::Mat& Mnb, int first, int step) const {
+    for (int r_idx = first; r_idx < im_size; r_idx += step) {
+      for (int c_idx = 0; c_idx < im_size; ++c_idx) {
+        int f_idx;
+        float c[3];
+        if (!grid.locate(r_idx, c_idx, f_idx, c))
+          continue;
+        sample<false>(grid.faceVertices(f_idx), c, acc, r_idx, c_idx);
+        Mnb.at<float>(r_idx, c_idx) = 1;
+      }
+    }
+  }
+
+private:
+  static void nearestCorner(const float c[3], float h[3]) {
+    int k = (c[0] >= c[1] && c[0] >= c[2]) ? 0 : (c[1] >= c[2] ? 1 : 2);
+    h[0] = h[1] = h[2] = 0;
+    h[k] = 1;
+  }
+
+  template <std::size_t I>
+  typename std::enable_if<I == sizeof...(Attrs), bool>::type
+  prepareAll(Surface_mesh&, const fs::path&, std::stringstream&) { return true; }
+  template <std::size_t I>
+  typename std::enable_if<I < sizeof...(Attrs), bool>::type
+  prepareAll(Surface_mesh& sm, const fs::path& inputPath, std::stringstream& LogFile) {
+    return std::get<I>(attrs).prepare(sm, inputPath, LogFile) && prepareAll<I + 1>(sm, inputPath, LogFile);
+  }
+
+  template <std::size_t I>
+  typename std::enable_if<I == sizeof...(Attrs)>::type
+  layoutAll(std::vector<GIChannels>&, int) const {}
+  template <std::size_t I>
+  typename std::enable_if<I < sizeof...(Attrs)>::type
+  layoutAll(std::vector<GIChannels>& out, int offset) const {
+    typedef typename std::tuple_element<I, attr_tuple>::type A;
+    GIChannels ch;
+    ch.name = A::name();
+    ch.offset = offset;
+    ch.channels = A::channels;
+    ch.encoding = A::encoding();
+    out.push_back(ch);
+    layoutAll<I + 1>(out, offset + A::channels);
+  }
+
+  template <std::size_t I>
+  typename std::enable_if<I == sizeof...(Attrs)>::type
+  fetchAll(vertex_descriptor, float*) const {}
+  template <std::size_t I>
+  typename std::enable_if<I < sizeof...(Attrs)>::type
+  fetchAll(vertex_descriptor vd, float* out) const {
+    std::get<I>(attrs).fetch(vd, out);
+    fetchAll<I + 1>(vd, out + std::tuple_element<I, attr_tuple>::type::channels);
+  }
+
+  template <std::size_t I, bool add>
+  typename std::enable_if<I == sizeof...(Attrs)>::type
+  accumulateAll(const float (*)[channels], const float*, const float*, cv::Mat*, int, int, bool) const {}
+  template <std::size_t I, bool add>
+  typename std::enable_if<I < sizeof...(Attrs)>::type
+  accumulateAll(const float (*V)[channels], const float* c, const float* h, cv::Mat* acc, int r_idx, int c_idx, bool first) const {
+    typedef typename std::tuple_element<I, attr_tuple>::type A;
+    // weights and channel range are compile-time constants of the attribute
+    const float* w = A::hard ? h : c;
+    const int offset = GIOffset<I>::value;
+    if (!add || !A::hard || first) {
+      for (int ch = 0; ch < A::channels; ++ch) {
+        float value = V[0][offset + ch] * w[0] + V[1][offset + ch] * w[1] + V[2][offset + ch] * w[2];
+        if (add && !A::hard)
+          acc[offset + ch].at<float>(r_idx, c_idx) += value;
+        else
+          acc[offset + ch].at<float>(r_idx, c_idx) = value;
+      }
+    }
+    accumulateAll<I + 1, add>(V, c, h, acc, r_idx, c_idx, first);
+  }
+
+  // first channel of attribute I
+  template <std::size_t I, typename Dummy = void> struct GIOffset {
+    enum { value = GIOffset<I - 1>::value + std::tuple_element<I - 1, attr_tuple>::type::channels };
+  };
+  template <typename Dummy> struct GIOffset<0, Dummy> {
+    enum { value = 0 };
+  };
+
+  attr_tuple attrs;
+};
+
+// Instantiates fn.template run<Attrs...>() for the attributes whose runtime switch in
+// on[] is set, so that each combination gets its own specialized generator
+template <typename... Attrs> struct GIList {};
+
+template <typename Selected, typename... Remaining> struct GISelect;
+template <typename... Selected> struct GISelect<GIList<Selected...> > {
+  template <typename Fn> static bool run(const bool* on, Fn& fn) {
+    return fn.template run<Selected...>();
+  }
+};
+template <typename... Selected, typename Head, typename... Tail>
+struct GISelect<GIList<Selected...>, Head, Tail...> {
+  template <typename Fn> static bool run(const bool* on, Fn& fn) {
+    if (*on)
+      return GISelect<GIList<Selected..., Head>, Tail...>::run(on + 1, fn);
+    return GISelect<GIList<Selected...>, Tail...>::run(on + 1, fn);
+  }
+};
+
+#endif /* GIGENERATOR_H_ */
@@ -0,0 +1,153 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "GIStats.h"
+
+GIStats::GIStats() {
+}
+
+GIStats::~GIStats() {
+  // TODO Auto-generated destructor stub
+}
+
+void GIStats::add(const std::string& name, const cv::Mat& img, const double* rawMin, const double* rawMax, int count) {
+  if (img.empty())
+    return;
+  int nChannels = img.channels();
+  cv::Mat x;
+  img.convertTo(x, CV_64FC(nChannels), img.depth() == CV_8U ? 1.0 / 255 : 1.0);
+
+  // a single image is an accumulator of its own, folding it in is a merge; an image standing
+  // for count identical inputs is an accumulator of count samples without variance
+  accumulator b;
+  b.n = count;
+  b.mean = x;
+  b.M2 = cv::Mat::zeros(x.size(), x.type());
+  b.min = x;
+  b.max = x;
+  // without the range before the encoding the values are stored as they are (colors, labels),
+  // so the range is taken from the unscaled pixels
+  std::vector<cv::Mat> planes;
+  if (!rawMin || !rawMax)
+    cv::split(img, planes);
+  b.rangeMin.resize(nChannels);
+  b.rangeMax.resize(nChannels);
+  for (int k = 0; k < nChannels; ++k) {
+    if (rawMin && rawMax) {
+      b.rangeMin[k] = rawMin[k];
+      b.rangeMax[k] = rawMax[k];
+    }
+    else
+      cv::minMaxLoc(planes[k], &b.rangeMin[k], &b.rangeMax[k]);
+  }
+
+  std::map<std::string, accumulator>::iterator it = acc.find(name);
+  if (it == acc.end()) {
+    // own the buffers, x is shared by mean, min and max of b
+    b.mean = x.clone();
+    b.min = x.clone();
+    acc[name] = b;
+  }
+  else
+    merge(it->second, b);
+}
+
+void GIStats::merge(const GIStats& other) {
+  for (std::map<std::string, accumulator>::const_iterator it = other.acc.begin(); it != other.acc.end(); ++it) {
+    std::map<std::string, accumulator>::iterator mine = acc.find(it->first);
+    if (mine == acc.end()) {
+      accumulator a;
+      a.n = it->second.n;
+      a.mean = it->second.mean.clone();
+      a.M2 = it->second.M2.clone();
+      a.min = it->second.min.clone();
+      a.max = it->second.max.clone();
+      a.rangeMin = it->second.rangeMin;
+      a.rangeMax = it->second.rangeMax;
+      acc[it->first] = a;
+    }
+    else
+      merge(mine->second, it->second);
+  }
+}
+
+bool GIStats::read(fs::path statsFile) {
+  cv::FileStorage fs_in(statsFile.string(), cv::FileStorage::READ);
+  if (!fs_in.isOpened()) {
+    std::cerr << "Couldn't open " << statsFile << " to read\n";
+    return false;
+  }
+  GIStats other;
+  cv::FileNode node = fs_in["GIStats"];
+  for (cv::FileNodeIterator it = node.begin(); it != node.end(); ++it) {
+    std::string name;
+    accumulator a;
+    (*it)["name"] >> name;
+    (*it)["count"] >> a.n;
+    (*it)["mean"] >> a.mean;
+    (*it)["M2"] >> a.M2;
+    (*it)["min"] >> a.min;
+    (*it)["max"] >> a.max;
+    (*it)["rangeMin"] >> a.rangeMin;
+    (*it)["rangeMax"] >> a.rangeMax;
+    if (a.mean.empty() || a.mean.size() != a.M2.size()) {
+      std::cerr << "Statistics of " << name << " in " << statsFile << " are incomplete\n";
+      return false;
+    }
+    other.acc[name] = a;
+  }
+  merge(other);
+  return true;
+}
+
+bool GIStats::write(fs::path statsFile) const {
+  // OpenCV storage, the format (.yml, .xml, optionally .gz) follows the extension
+  cv::FileStorage fs_out(statsFile.string(), cv::FileStorage::WRITE);
+  if (!fs_out.isOpened()) {
+    std::cerr << "Couldn't open " << statsFile << " to write\n";
+    return false;
+  }
+  fs_out << "GIStats" << "[";
+  for (std::map<std::string, accumulator>::const_iterator it = acc.begin(); it != acc.end(); ++it) {
+    const accumulator& a = it->second;
+    fs_out << "{" << "name" << it->first << "count" << a.n
+        << "mean" << a.mean << "variance" << cv::Mat(a.M2 / a.n) << "M2" << a.M2
+        << "min" << a.min << "max" << a.max
+        << "rangeMin" << a.rangeMin << "rangeMax" << a.rangeMax << "}";
+  }
+  fs_out << "]";
+  return true;
+}
+
+bool GIStats::writeMeanShape(fs::path meanFile) const {
+  // mean of the vertex GI as 16 bit png, it replaces meanShape.png of the python loaders
+  std::map<std::string, accumulator>::const_iterator it = acc.find("flatGI");
+  if (it == acc.end())
+    return false;
+  cv::Mat meanShape;
+  it->second.mean.convertTo(meanShape, CV_16UC(it->second.mean.channels()), 65535);
+  return cv::imwrite(meanFile.string(), meanShape);
+}
+
+
+// private
+void GIStats::merge(accumulator& a, const accumulator& b) {
+  // Chan et al. pairwise update of mean and sum of squared deviations
+  double n = a.n + b.n;
+  cv::Mat delta = b.mean - a.mean;
+  a.M2 += b.M2 + delta.mul(delta) * (a.n * b.n / n);
+  a.mean += delta * (b.n / n);
+  a.n = n;
+  a.min = cv::min(a.min, b.min);
+  a.max = cv::max(a.max, b.max);
+  for (std::size_t k = 0; k < a.rangeMin.size() && k < b.rangeMin.size(); ++k) {
+    a.rangeMin[k] = std::min(a.rangeMin[k], b.rangeMin[k]);
+    a.rangeMax[k] = std::max(a.rangeMax[k], b.rangeMax[k]);
+  }
+}
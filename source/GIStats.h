@@ -0,0 +1,45 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef GISTATS_H_
+#define GISTATS_H_
+
+#include "include.h"
+
+#include <map>
+
+// Streaming per-pixel statistics of the geometry images of a batch, one accumulator per GI
+// type (flatGI, nflatGI, ...). Images are folded in as they are written: 8 bit images as
+// values in [0,1] like the python loaders read them, 16 bit label images unscaled. Mean and
+// variance follow Welford's update, so partial statistics of shards merge exactly in any order.
+class GIStats {
+public:
+  struct accumulator {
+    double n; // number of folded images
+    cv::Mat mean, M2, min, max; // per pixel, CV_64F with the channels of the GI
+    std::vector<double> rangeMin, rangeMax; // per channel range of the values before 8 bit encoding, in mesh
+                                            // units, which for colors and labels are the pixel values
+  };
+
+  GIStats();
+  virtual ~GIStats();
+  bool empty() const { return acc.empty(); }
+  void add(const std::string& name, const cv::Mat& img, const double* rawMin=NULL, const double* rawMax=NULL, int count=1);
+  void merge(const GIStats& other);
+  bool read(fs::path statsFile);
+  bool write(fs::path statsFile) const;
+  bool writeMeanShape(fs::path meanFile) const;
+
+private:
+  static void merge(accumulator& a, const accumulator& b);
+
+  std::map<std::string, accumulator> acc;
+};
+
+#endif /* GISTATS_H_ */
@@ -0,0 +1,256 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Isolation.h"
+
+#include <cstdint>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int Isolation::childFd = -1;
+
+Isolation::Isolation(int timeoutSec, int memMB, int batchSize):
+timeoutSec(timeoutSec), memMB(memMB), batchSize(std::max(1, batchSize)), items(nullptr), current(-1), currentDone(true) {
+}
+
+Isolation::~Isolation() {
+  // TODO Auto-generated destructor stub
+}
+
+void Isolation::run(const std::vector<fs::path>& items, std::function<bool(int)> processItem,
+    std::function<void(int)> finishItem, std::function<void(int, bool)> itemFinished) {
+  this->items = &items;
+  this->itemFinished = itemFinished;
+  int nItems = items.size();
+  int next = 0;
+  while (next < nItems) {
+    int first = next;
+    if (!runWorker(first, std::min(nItems, first + batchSize), processItem, finishItem, next))
+      return;
+  }
+}
+
+bool Isolation::inChild() {
+  return childFd >= 0;
+}
+
+void Isolation::stage(const std::string& name) {
+  if (inChild())
+    send('S', name);
+}
+
+void Isolation::itemDone(bool ok, const std::string& file, double ms, const std::string& log,
+    const std::string& progress, const Logger::metrics& kv) {
+  if (!inChild())
+    return;
+  send('F', file);
+  send('L', log);
+  send('P', progress);
+  // key, N for a number or S for a string, and the formatted value
+  for (std::size_t i = 0; i < kv.size(); ++i)
+    send('K', kv[i].first + "\t" + (kv[i].second.numeric ? "N" : "S") + kv[i].second.text);
+  std::stringstream ss;
+  ss << ok << " " << ms;
+  send('E', ss.str());
+}
+
+// private
+bool Isolation::runWorker(int first, int end, std::function<bool(int)>& processItem,
+    std::function<void(int)>& finishItem, int& next) {
+  int fd[2];
+  if (pipe(fd) != 0) {
+    std::cerr << "Couldn't create pipe for worker\n";
+    return false;
+  }
+  // nothing may be buffered in the streams when forking, or the worker prints it again
+  std::cout << std::flush;
+  std::cerr << std::flush;
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "Couldn't fork worker\n";
+    close(fd[0]);
+    close(fd[1]);
+    return false;
+  }
+
+  if (pid == 0) {
+    // worker: only the calling thread exists here, so the logger must not be used
+    close(fd[0]);
+    childFd = fd[1];
+    // own group for the worker and what it starts; the worker itself goes when the parent does
+    setpgid(0, 0);
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() == 1)
+      _exit(1);
+    if (memMB > 0) {
+      struct rlimit lim;
+      lim.rlim_cur = lim.rlim_max = (rlim_t) memMB << 20;
+      setrlimit(RLIMIT_AS, &lim);
+    }
+    for (int i = first; i < end; ++i) {
+      send('B', std::to_string(i));
+      try {
+        processItem(i);
+      } catch (std::bad_alloc&) {
+        send('X', "memory limit");
+        _exit(3);
+      } catch (...) {
+        send('X', "exception");
+        _exit(2);
+      }
+      if (finishItem)
+        finishItem(first);
+    }
+    _exit(0);
+  }
+
+  // parent: follow the worker and enforce the stage time limit; the group is also set here so that
+  // it exists before the first kill, whichever process runs first
+  setpgid(pid, pid);
+  close(fd[1]);
+  current = first - 1;
+  currentDone = true;
+  currentStage = "start";
+  stageStart = std::chrono::steady_clock::now();
+  std::string buffer, reason;
+  int status = 0;
+  bool exited = false;
+  while (!exited) {
+    struct pollfd pfd;
+    pfd.fd = fd[0];
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 100) > 0)
+      receive(fd[0], buffer);
+
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+      // drain what the worker wrote before it exited
+      while (receive(fd[0], buffer)) {}
+      exited = true;
+    }
+    else if (timeoutSec > 0 && !currentDone &&
+        std::chrono::steady_clock::now() - stageStart > std::chrono::seconds(timeoutSec)) {
+      kill(-pid, SIGKILL);
+      waitpid(pid, &status, 0);
+      reason = "timeout";
+      exited = true;
+    }
+  }
+  close(fd[0]);
+  // programs left running by a crashed worker
+  if (WIFSIGNALED(status))
+    kill(-pid, SIGKILL);
+
+  // a worker lost before it reported an item is charged to its first item
+  if (current < first) {
+    current = first;
+    currentDone = false;
+  }
+  if (!currentDone) {
+    if (reason.empty()) {
+      if (WIFSIGNALED(status))
+        reason = std::string("signal ") + std::to_string(WTERMSIG(status));
+      else
+        reason = std::string("exit ") + std::to_string(WEXITSTATUS(status));
+    }
+    failure f = { current, currentStage, reason };
+    failed.push_back(f);
+    Logger::metrics kv;
+    Logger::metric(kv, "reason", reason);
+    Log.log(Logger::ERROR, (*items)[current].string(), currentStage, 0, "", kv);
+    Log.progress(std::string(" worker lost in ") + currentStage + " (" + reason + ")\n", true);
+  }
+  // continue after the last item the worker started, a lost item is not retried
+  next = current + 1;
+  return true;
+}
+
+void Isolation::send(char type, const std::string& payload) {
+  // frame: type, payload length, payload
+  uint32_t len = payload.size();
+  std::string frame(1, type);
+  frame.append(reinterpret_cast<const char*>(&len), sizeof(len));
+  frame.append(payload);
+  std::size_t written = 0;
+  while (written < frame.size()) {
+    ssize_t n = write(childFd, frame.data() + written, frame.size() - written);
+    if (n <= 0)
+      return;
+    written += n;
+  }
+}
+
+bool Isolation::receive(int fd, std::string& buffer) {
+  char chunk[4096];
+  ssize_t n = read(fd, chunk, sizeof(chunk));
+  if (n <= 0)
+    return false;
+  buffer.append(chunk, n);
+  // handle every complete frame
+  std::size_t pos = 0;
+  while (buffer.size() - pos >= 1 + sizeof(uint32_t)) {
+    uint32_t len;
+    memcpy(&len, buffer.data() + pos + 1, sizeof(len));
+    if (buffer.size() - pos < 1 + sizeof(len) + len)
+      break;
+    handle(buffer[pos], buffer.substr(pos + 1 + sizeof(len), len));
+    pos += 1 + sizeof(len) + len;
+  }
+  buffer.erase(0, pos);
+  return true;
+}
+
+void Isolation::handle(char type, const std::string& payload) {
+  switch (type) {
+  case 'B':
+    current = atoi(payload.c_str());
+    currentDone = false;
+    currentStage = "start";
+    stageStart = std::chrono::steady_clock::now();
+    pending = Logger::record();
+    pending.stage = "item";
+    break;
+  case 'S':
+    currentStage = payload;
+    stageStart = std::chrono::steady_clock::now();
+    break;
+  case 'F':
+    pending.file = payload;
+    break;
+  case 'L':
+    pending.message = payload;
+    break;
+  case 'P':
+    Log.progress(payload, false);
+    break;
+  case 'K': {
+    std::size_t tab = payload.find('\t');
+    Logger::value val = { payload.substr(tab + 2), payload[tab + 1] == 'N' };
+    pending.kv.push_back(std::make_pair(payload.substr(0, tab), val));
+    break;
+  }
+  case 'E': {
+    std::stringstream ss(payload);
+    bool ok;
+    ss >> ok >> pending.ms;
+    pending.lvl = ok ? Logger::INFO : Logger::ERROR;
+    Log.log(pending);
+    currentDone = true;
+    if (itemFinished)
+      itemFinished(current, ok);
+    break;
+  }
+  case 'X':
+    currentStage += " (" + payload + ")";
+    break;
+  }
+}
@@ -0,0 +1,69 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef ISOLATION_H_
+#define ISOLATION_H_
+
+#include "include.h"
+
+#include <functional>
+
+// Runs the items of the batch in forked worker processes, each worker processes a batch of
+// items and reports the stage it is in over a pipe. A worker which exceeds the wall clock
+// limit of a stage is killed; killed, crashed or out of memory items are recorded with the
+// stage they died in and the next worker continues with the following item. Every worker is
+// the leader of its own process group, so programs it started (meshlabserver) are killed with it.
+class Isolation {
+public:
+  struct failure {
+    int item;
+    std::string stage;
+    std::string reason;
+  };
+
+  Isolation(int timeoutSec, int memMB, int batchSize);
+  virtual ~Isolation();
+  // finishItem is called in a worker after each item it processed, with the first item of the batch;
+  // itemFinished is called in the parent for every item a worker reported as done
+  void run(const std::vector<fs::path>& items, std::function<bool(int)> processItem,
+      std::function<void(int)> finishItem = std::function<void(int)>(),
+      std::function<void(int, bool)> itemFinished = std::function<void(int, bool)>());
+  const std::vector<failure>& failures() const { return failed; }
+
+  // called from inside the worker, no-ops in the parent process
+  static bool inChild();
+  static void stage(const std::string& name);
+  static void itemDone(bool ok, const std::string& file, double ms, const std::string& log,
+      const std::string& progress, const Logger::metrics& kv);
+
+private:
+  bool runWorker(int first, int end, std::function<bool(int)>& processItem,
+      std::function<void(int)>& finishItem, int& next);
+  static void send(char type, const std::string& payload);
+  bool receive(int fd, std::string& buffer);
+  void handle(char type, const std::string& payload);
+
+  int timeoutSec; // wall clock limit per stage, 0 disables the watchdog
+  int memMB;  // address space limit per worker, 0 disables the limit
+  int batchSize;  // number of items per worker
+  std::vector<failure> failed;
+  const std::vector<fs::path>* items;
+  std::function<void(int, bool)> itemFinished;
+
+  // state of the current worker as reported over the pipe
+  int current;
+  bool currentDone;
+  std::string currentStage;
+  std::chrono::steady_clock::time_point stageStart;
+  Logger::record pending;
+
+  static int childFd; // write end of the pipe in the worker, -1 in the parent
+};
+
+#endif /* ISOLATION_H_ */
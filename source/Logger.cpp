@@ -0,0 +1,192 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Logger.h"
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+  // ring of the calling thread, registered with the logger on first use
+  thread_local void* tlRing = nullptr;
+  thread_local const Logger* tlOwner = nullptr;
+}
+
+std::stringstream& Progress() {
+  thread_local std::stringstream progressSS;
+  return progressSS;
+}
+
+Logger::Logger(): stop(true), progressMs(0) {
+}
+
+Logger::~Logger() {
+  close();
+}
+
+bool Logger::open(std::string textPath, std::string jsonPath, int progressMs) {
+  textFile.open(textPath.c_str(), std::ios::app);
+  if (textFile.fail())
+    return false;
+  if (!jsonPath.empty()) {
+    jsonFile.open(jsonPath.c_str(), std::ios::app);
+    if (jsonFile.fail())
+      return false;
+  }
+  this->progressMs = progressMs;
+  this->lastProgress = std::chrono::steady_clock::now() - std::chrono::milliseconds(progressMs);
+  stop = false;
+  sink = std::thread(&Logger::run, this);
+  return true;
+}
+
+void Logger::close() {
+  if (stop)
+    return;
+  stop = true;
+  sink.join();
+  // records pushed after the sink saw the stop flag
+  drain();
+  textFile.close();
+  if (jsonFile.is_open())
+    jsonFile.close();
+}
+
+void Logger::log(record& r) {
+  if (stop)
+    return;
+  ring& rg = localRing();
+  // a full ring means the sink is behind, wait instead of dropping the record
+  while (!rg.push(r))
+    std::this_thread::yield();
+}
+
+void Logger::log(level lvl, std::string file, std::string stage, double ms, std::string message, metrics kv) {
+  record r;
+  r.lvl = lvl;
+  r.file = file;
+  r.stage = stage;
+  r.ms = ms;
+  r.message = message;
+  r.kv.swap(kv);
+  log(r);
+}
+
+void Logger::progress(const std::string& line, bool force) {
+  std::lock_guard<std::mutex> lock(progressMtx);
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (!force && now - lastProgress < std::chrono::milliseconds(progressMs))
+    return;
+  lastProgress = now;
+  std::cout << line << std::flush;
+}
+
+// private
+bool Logger::ring::push(record& r) {
+  std::size_t h = head.load(std::memory_order_relaxed);
+  if (h - tail.load(std::memory_order_acquire) == N)
+    return false;
+  slot[h % N] = std::move(r);
+  head.store(h + 1, std::memory_order_release);
+  return true;
+}
+
+bool Logger::ring::pop(record& r) {
+  std::size_t t = tail.load(std::memory_order_relaxed);
+  if (t == head.load(std::memory_order_acquire))
+    return false;
+  r = std::move(slot[t % N]);
+  tail.store(t + 1, std::memory_order_release);
+  return true;
+}
+
+Logger::ring& Logger::localRing() {
+  if (tlOwner != this || tlRing == nullptr) {
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    rings.push_back(std::unique_ptr<ring>(new ring));
+    tlRing = rings.back().get();
+    tlOwner = this;
+  }
+  return *static_cast<ring*>(tlRing);
+}
+
+void Logger::run() {
+  while (!stop) {
+    if (!drain())
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+bool Logger::drain() {
+  std::vector<ring*> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    for (std::size_t i = 0; i < rings.size(); ++i)
+      snapshot.push_back(rings[i].get());
+  }
+  bool drained = false;
+  record r;
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    while (snapshot[i]->pop(r)) {
+      write(r);
+      drained = true;
+    }
+  }
+  if (drained) {
+    textFile.flush();
+    if (jsonFile.is_open())
+      jsonFile.flush();
+  }
+  return drained;
+}
+
+void Logger::write(record& r) {
+  if (!r.message.empty())
+    textFile << r.message;
+  if (!jsonFile.is_open())
+    return;
+
+  static const char* levelName[] = { "info", "warn", "error" };
+  jsonFile << "{\"file\":\"" << jsonEscape(r.file) << "\",\"stage\":\"" << jsonEscape(r.stage)
+      << "\",\"level\":\"" << levelName[r.lvl] << "\",\"ms\":" << r.ms;
+  if (!r.message.empty())
+    jsonFile << ",\"message\":\"" << jsonEscape(r.message) << "\"";
+  for (std::size_t i = 0; i < r.kv.size(); ++i) {
+    jsonFile << ",\"" << jsonEscape(r.kv[i].first) << "\":";
+    if (r.kv[i].second.numeric)
+      jsonFile << r.kv[i].second.text;
+    else
+      jsonFile << "\"" << jsonEscape(r.kv[i].second.text) << "\"";
+  }
+  jsonFile << "}\n";
+}
+
+std::string Logger::jsonEscape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    char ch = s[i];
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+      out += ch;
+    }
+    else if (ch == '\n')
+      out += "\\n";
+    else if (ch == '\t')
+      out += "\\t";
+    else if ((unsigned char) ch < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", ch);
+      out += buf;
+    }
+    else
+      out += ch;
+  }
+  return out;
+}
@@ -0,0 +1,104 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Asynchronous structured logger. Every producing thread owns a lock-free single producer
+// ring of records, a sink thread drains the rings into the report log and optionally into
+// a JSONL file. Console progress is rate limited instead of flushed on every event.
+class Logger {
+public:
+  enum level { INFO = 0, WARN, ERROR };
+  // formatted metric, numbers and booleans are written to JSONL without quotes
+  struct value {
+    std::string text;
+    bool numeric;
+  };
+  typedef std::vector<std::pair<std::string, value> > metrics;
+
+  struct record {
+    level lvl;
+    std::string file; // input file the record belongs to
+    std::string stage;  // pipeline stage, "item" for the summary of one file
+    double ms;  // wall clock time of the stage
+    std::string message;  // free text, written as is to the report log
+    metrics kv; // key/value metrics, only written to JSONL
+  };
+
+  Logger();
+  virtual ~Logger();
+  bool open(std::string textPath, std::string jsonPath, int progressMs);
+  void close();
+  void log(record& r);
+  void log(level lvl, std::string file, std::string stage, double ms, std::string message, metrics kv=metrics());
+  void progress(const std::string& line, bool force=false);
+
+  template <typename T>
+  static void metric(metrics& kv, std::string key, const T& v) {
+    std::stringstream ss;
+    ss << std::boolalpha << v;
+    value val = { ss.str(), std::is_arithmetic<T>::value };
+    // JSON has no inf or nan
+    if (val.numeric && !finite(v))
+      val.text = "null";
+    kv.push_back(std::make_pair(key, val));
+  }
+
+private:
+  struct ring {
+    static const std::size_t N = 1024;
+    record slot[N];
+    std::atomic<std::size_t> head; // next slot written, only advanced by the producer
+    std::atomic<std::size_t> tail; // next slot read, only advanced by the sink
+    ring(): head(0), tail(0) {}
+    bool push(record& r);
+    bool pop(record& r);
+  };
+
+  ring& localRing();
+  void run();
+  bool drain();
+  void write(record& r);
+  static std::string jsonEscape(const std::string& s);
+  static bool finite(double v) { return std::isfinite(v); }
+  static bool finite(float v) { return std::isfinite(v); }
+  template <typename T>
+  static bool finite(const T&) { return true; }
+
+  std::ofstream textFile, jsonFile;
+  std::vector<std::unique_ptr<ring> > rings;
+  std::mutex ringsMtx; // guards registration of rings, not the records
+  std::atomic<bool> stop;
+  std::thread sink;
+  int progressMs; // minimum time between two console progress lines
+  std::chrono::steady_clock::time_point lastProgress;
+  std::mutex progressMtx;
+};
+
+// the single logger of the program
+extern Logger Log;
+
+// console progress of the current file on the calling thread, handed to Log.progress() once per file
+std::stringstream& Progress();
+
+#endif /* LOGGER_H_ */
@@ -17,6 +17,15 @@ int main(int argc, char * argv[]) {
   Paths.fldPre = "NULL";
   Paths.flStr = "NULL";
   Paths.DBPath = Paths.listFilePath.parent_path();
+  Flag.prefetchMB = 1024;
+  Flag.progressMs = 1000;
+  Flag.isolateBatch = 1;
+  Flag.refineDensity = std::sqrt(2.0);
+  Flag.fillIter = 20;
+  Flag.param = "authalic";
+  Flag.mlMinVertices = 2000;
+  Flag.mlIter = 2;
+  Flag.watchDebounceMs = 500;
 
   if(!getFlags(argv, argc))
     return -1;
@@ -28,7 +37,7 @@ int main(int argc, char * argv[]) {
       return -1;
     return 0;
   }
-  else if (pr_mode == 1)	{
+  else if (pr_mode == 1 && Flag.watch.empty())	{
     if(!Tx.listFilesFromFile())
       return -1;
   }
@@ -41,9 +50,9 @@ int main(int argc, char * argv[]) {
     srand(time(NULL));
     logFilePath += std::to_string(rand());
   }
+  std::string jsonFilePath = Flag.jsonl ? logFilePath + ".jsonl" : "";
   logFilePath += ".txt";
-  LogFile.open(logFilePath.c_str(), std::ios::app);
-  if (LogFile.fail()) {
+  if (!Log.open(logFilePath, jsonFilePath, Flag.progressMs)) {
     std::cerr << "    Couldn't open LogFile to write\n";
     throw std::ios_base::failure(std::strerror(errno));
     return -1;
@@ -51,8 +60,11 @@ int main(int argc, char * argv[]) {
   else  {
     std::time_t timeStamp = std::time(nullptr);
     std::cout << std::ctime(&timeStamp);
-    LogFile << std::ctime(&timeStamp);
-    LogFile << "Processing Files from list file " << Paths.listFilePath << " & writing files to " << Paths.fldPre << std::endl;
+    std::stringstream tmpSS;
+    tmpSS << std::ctime(&timeStamp);
+    tmpSS << "Processing Files from list file " << Paths.listFilePath << " & writing files to " << Paths.fldPre << std::endl;
+    tmpSS << "GI kernels use " << Simd::name(Simd::active()) << std::endl;
+    Log.log(Logger::INFO, Paths.listFilePath.string(), "start", 0, tmpSS.str());
   }
 
   fs::path outModelFilePath = Paths.DBPath / Paths.fldPre;
@@ -64,63 +76,313 @@ int main(int argc, char * argv[]) {
     fs::create_directory(outModelFilePath.string().substr(0, backslash + 1));
     backslash = outModelFilePath.string().find('/', backslash + 1);
   }
+  // outputs are appended to the pack of the output folder instead of being written as files
+  if (Flag.pack)
+    Pack::enableWrite(outModelFilePath);
+
+  // inputs with the geometry of an earlier input of the list are not processed again
+  std::vector<fs::path> fullList = Paths.modelFilePathList;
+  Dedup DD(fullList, Flag.dedup);
+  std::vector<int> copies;  // inputs each item of the list stands for, counted in the GI statistics
+  if (Flag.dedup > 0) {
+    DD.run();
+    Paths.modelFilePathList = DD.canonicals();
+    copies = DD.groupSizes();
+    std::stringstream tmpSS;
+    tmpSS << DD.nDuplicates() << " of " << fullList.size() << " inputs are duplicates, dedup ratio "
+        << (double) fullList.size() / std::max<std::size_t>(1, Paths.modelFilePathList.size()) << std::endl;
+    std::cout << tmpSS.str();
+    Logger::metrics kv;
+    Logger::metric(kv, "inputs", (double) fullList.size());
+    Logger::metric(kv, "duplicates", (double) DD.nDuplicates());
+    Log.log(Logger::INFO, Paths.listFilePath.string(), "dedup", 0, tmpSS.str(), kv);
+  }
+
+  if (Flag.sweep) {
+    // every combination of the sweep settings is run on the list instead of the regular processing
+    Sweep SW(Flag, Paths.modelFilePathList, outModelFilePath / "sweep/");
+    bool ok = SW.run(logFilePath.substr(0, logFilePath.length() - 4) + "_sweep.txt");
+    Log.close();
+    std::cout << "Log written to " << logFilePath << std::endl;
+    return ok ? 0 : -1;
+  }
+
+  // storage reused by all the files processed below
+  Workspace WS;
+  // part file of the GI statistics written by the isolated worker starting at item first
+  std::function<fs::path(int)> statsPart = [&](int first) {
+    fs::path statsPath(Flag.giStats);
+    return statsPath.parent_path() / ("part" + std::to_string(first) + "_" + statsPath.filename().string());
+  };
+  // parse the input meshes ahead of the loop on a loader thread
+  std::unique_ptr<Prefetcher> PF;
+  // workers of the isolated mode parse their own input, a loader thread does not survive the fork;
+  // the list of the watch mode grows while it is processed and has nothing to parse ahead
+  if (Flag.prefetch > 0 && !Flag.isolate && Flag.watch.empty())
+    PF.reset(new Prefetcher(Paths.modelFilePathList, Flag.prefetch, (std::size_t) Flag.prefetchMB << 20));
 
+  // items processed successfully, counted in the parent process while isolated, so every worker
+  // continues the numbering from the state it was forked in
   int counter = 0;
-  // execute main for list of all files in modelFilePathList
-  for (int i = 0; i < Paths.modelFilePathList.size(); i++) {
+  std::stringstream LogSS;  // log of the current file, handed to the logger once the file is done
+  // process one file of modelFilePathList, either in this process or in an isolated worker
+  std::function<bool(int)> processItem = [&](int i) -> bool {
     std::chrono::high_resolution_clock::time_point begin_t = std::chrono::high_resolution_clock::now();
-    if (!LogSS.str().empty()) {
-      LogFile << LogSS.str() << std::flush;
-      LogSS.str(std::string());
-    }
     fs::path modelFilePath = Paths.modelFilePathList[i];
-    LogSS << modelFilePath.string() << " : " << std::flush;
-    std::cout << modelFilePath.string() << " : " << std::flush;
+    WS.beginItem(i < (int) copies.size() ? copies[i] : 1);
+    if (PF)
+      PF->take(WS);
+    LogSS.str(std::string());
+    Progress().str(std::string());
+    LogSS << modelFilePath.string() << " : ";
+    Progress() << modelFilePath.string() << " : ";
+    Logger::metrics kv;
+    bool ok = true;
 
     // Preprocess: Slice input mesh for parameterization
-    Preprocess PP(LogSS, modelFilePath, outModelFilePath);
-    if (Flag.slice) {
-      if(!PP.slice())
-        continue;
-    }
+    Preprocess PP(LogSS, WS, modelFilePath, outModelFilePath, Flag);
+    if (ok && Flag.slice)
+      ok = runStage("slice", modelFilePath, [&] { return PP.slice(); }, kv);
 
     // Parameterization: To perform iterative parameterization, obtain geometry image and remesh from GI
-    Parameterization PM(LogSS, modelFilePath, outModelFilePath, Flag.useNormal, Flag.im_size);
-    if (Flag.sPI)  {
-      if(!PM.surfaceParameteriseIterative(Flag.sPIterations))
-        continue;
-    }
+    Parameterization PM(LogSS, WS, modelFilePath, outModelFilePath, Flag);
+    if (ok && Flag.sPI)
+      ok = runStage("sPI", modelFilePath, [&] { return PM.surfaceParameteriseIterative(Flag.sPIterations); }, kv);
     if (Flag.m2G)  {
-      if(!PM.mesh2GI())
-        continue;
+      if (ok)
+        ok = runStage("m2G", modelFilePath, [&] { return PM.mesh2GI(); }, kv);
     }
     else if (Flag.G2o) {
-      if(!PM.GI2off())
-        continue;
+      if (ok)
+        ok = runStage("G2o", modelFilePath, [&] { return PM.GI2off(); }, kv);
     }
+    // the predicted GI is looked up at the pixels of the slice vertices written by m2G
+    if (ok && !Flag.applyGI.empty())
+      ok = runStage("aGI", modelFilePath, [&] { return PM.applyGI(); }, kv);
 
-    std::time_t timeStamp = std::time(nullptr);
-    std::stringstream tmpSS;
-    tmpSS << " ******************** " << ++counter << "-" << i + 1 << "/" << Paths.modelFilePathList.size() << " ("
-        << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now()-begin_t).count()
-        << " sec) " << std::ctime(&timeStamp);
-    std::cout << tmpSS.str();
-    LogSS << tmpSS.str();
+    double ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()-begin_t).count() / 1000.0;
+    if (ok) {
+      std::time_t timeStamp = std::time(nullptr);
+      std::stringstream tmpSS;
+      tmpSS << " ******************** " << ++counter << "-" << i + 1 << "/" << Paths.modelFilePathList.size() << " ("
+          << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now()-begin_t).count()
+          << " sec) " << std::ctime(&timeStamp);
+      Progress() << tmpSS.str();
+      LogSS << tmpSS.str();
+    }
+    else
+      Progress() << " failed\n";
+    Logger::metric(kv, "ok", ok);
+    if (Isolation::inChild())
+      Isolation::itemDone(ok, modelFilePath.string(), ms, LogSS.str(), Progress().str(), kv);
+    else {
+      Log.log(ok ? Logger::INFO : Logger::ERROR, modelFilePath.string(), "item", ms, LogSS.str(), kv);
+      Log.progress(Progress().str(), i + 1 == Paths.modelFilePathList.size());
+    }
+    return ok;
+  };
+
+  if (!Flag.watch.empty()) {
+    // files arriving in the watched folder are appended to the list and processed once they are complete
+    Watcher WA(Paths.DBPath / Flag.watch, Paths.ext, Paths.flStr, Flag.watchDebounceMs);
+    if (!WA.start()) {
+      Log.close();
+      return -1;
+    }
+    std::cout << "Watching " << Paths.DBPath / Flag.watch << " for new files, stop with Ctrl+C" << std::endl;
+    signal(SIGINT, stopWatch);
+    signal(SIGTERM, stopWatch);
+    std::vector<fs::path> ready;
+    while (!watchStopped) {
+      WA.wait(ready, std::min(Flag.watchDebounceMs, 1000));
+      for (std::size_t k = 0; k < ready.size() && !watchStopped; ++k) {
+        // a rewritten input is processed again, the stages would otherwise keep its outputs
+        removeStale(ready[k], outModelFilePath);
+        Paths.modelFilePathList.push_back(ready[k]);
+        processItem(Paths.modelFilePathList.size() - 1);
+      }
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    std::cout << "Stopped watching after " << Paths.modelFilePathList.size() << " files" << std::endl;
+  }
+  else if (Flag.isolate) {
+    // items are run in forked workers, stalled or crashed ones are listed in the failure file
+    Isolation ISO(Flag.timeout, Flag.memMB, Flag.isolateBatch);
+    // a worker leaves the GI statistics of its batch in a part file, merged below; the part is
+    // replaced after every item, so the items done before a crash of the worker are kept
+    std::function<void(int)> finishItem;
+    if (!Flag.giStats.empty())
+      finishItem = [&](int first) {
+        fs::path part = statsPart(first);
+        fs::path tmp = part.parent_path() / ("tmp_" + part.filename().string());
+        if (WS.stats.write(tmp))
+          fs::rename(tmp, part);
+      };
+    ISO.run(Paths.modelFilePathList, processItem, finishItem, [&](int, bool ok) { counter += ok; });
+    if (!Flag.giStats.empty()) {
+      for (int i = 0; i < Paths.modelFilePathList.size(); i++) {
+        if (fs::exists(statsPart(i)) && WS.stats.read(statsPart(i)))
+          fs::remove(statsPart(i));
+      }
+    }
+    std::string failFilePath = logFilePath.substr(0, logFilePath.length() - 4) + "_failures.txt";
+    std::ofstream failFile(failFilePath.c_str(), std::ios::app);
+    for (std::size_t f = 0; f < ISO.failures().size(); ++f) {
+      const Isolation::failure& F = ISO.failures()[f];
+      failFile << Paths.modelFilePathList[F.item].string() << "\t" << F.stage << "\t" << F.reason << "\n";
+    }
+    std::cout << ISO.failures().size() << " failures written to " << failFilePath << std::endl;
+  }
+  else {
+    // execute main for list of all files in modelFilePathList
+    for (int i = 0; i < Paths.modelFilePathList.size(); i++)
+      processItem(i);
+  }
+  PF.reset();
+  if (Flag.dedup > 0)
+    std::cout << DD.link(outModelFilePath) << " outputs linked to duplicates" << std::endl;
+
+  if (!Flag.giStats.empty()) {
+    // statistics of earlier runs or other shards are merged into the ones of this batch
+    for (std::size_t k = 0; k < Flag.mergeStats.size(); ++k)
+      WS.stats.read(Flag.mergeStats[k]);
+    fs::path statsPath(Flag.giStats);
+    std::string meanPath = (statsPath.parent_path() / statsPath.filename().string().substr(0, statsPath.filename().string().find('.'))).string() + "_meanShape.png";
+    if (WS.stats.write(statsPath)) {
+      std::cout << "GI statistics written to " << statsPath.string() << std::endl;
+      if (WS.stats.writeMeanShape(meanPath))
+        std::cout << "Mean shape written to " << meanPath << std::endl;
+    }
   }
-  // required for last file
-  if (!LogSS.str().empty())
-    LogFile << LogSS.str();
 
   std::stringstream tmpSS;
   tmpSS << "Finished in "<< std::chrono::duration_cast<std::chrono::minutes>(std::chrono::high_resolution_clock::now()-begin_main).count() << " min " << std::endl;
   std::cout << tmpSS.str();
-  LogFile << tmpSS.str();
+  Log.log(Logger::INFO, Paths.listFilePath.string(), "finish", 0, tmpSS.str());
 
-  LogFile.close();
+  Log.close();
   std::cout << "Log written to " << logFilePath << std::endl;
   return 0;
 }
 
+void stopWatch(int) {
+  watchStopped = 1;
+}
+
+void removeStale(fs::path input, fs::path outputPath) {
+  // outputs of an earlier version of the input: <name>.off, <name>_<tag>.off of the slice planes
+  // and everything of <name>_arcSMI, as far as they are older than the input
+  std::string stem = input.stem().string();
+  std::vector<std::string> names(1, stem + ".off");
+  for (std::size_t k = 0; k < Flag.planes.size(); ++k)
+    names.push_back(stem + "_" + Flag.planes[k].tag + ".off");
+  std::string param = stem + "_arcSMI";
+  std::function<bool(const std::string&)> output = [&](const std::string& name) {
+    return std::find(names.begin(), names.end(), name) != names.end() ||
+        (name.compare(0, param.size(), param) == 0 && (name.size() == param.size() || name[param.size()] == '.' || name[param.size()] == '_'));
+  };
+  // packed outputs carry no time stamp, all of them are replaced
+  std::shared_ptr<Pack> P = Pack::reader(outputPath / input.filename());
+  std::vector<std::string> packed = P ? P->names() : std::vector<std::string>();
+  for (std::size_t k = 0; k < packed.size(); ++k) {
+    if (output(packed[k]))
+      P->erase(packed[k]);
+  }
+  boost::system::error_code ec;
+  std::time_t written = fs::last_write_time(input, ec);
+  if (ec)
+    return;
+  // the masks of mesh2GI are in the _msk folder next to the output folder
+  std::string folder = outputPath.string();
+  while (folder.size() > 1 && folder[folder.size() - 1] == '/')
+    folder.erase(folder.size() - 1);
+  fs::path folders[] = { outputPath, fs::path(folder + "_msk") };
+  for (int k = 0; k < 2; ++k) {
+    if (!fs::is_directory(folders[k]))
+      continue;
+    for (fs::directory_iterator it(folders[k]); it != fs::directory_iterator(); ++it) {
+      if (output(it->path().filename().string()) && fs::is_regular_file(it->path()) && fs::last_write_time(it->path(), ec) <= written)
+        fs::remove(it->path(), ec);
+    }
+  }
+}
+
+bool runStage(std::string stage, fs::path& modelFilePath, std::function<bool()> fn, Logger::metrics& kv) {
+  // time one stage of the current file and record it, the stage writes its own messages to LogSS
+  Isolation::stage(stage);
+  std::chrono::high_resolution_clock::time_point begin_s = std::chrono::high_resolution_clock::now();
+  bool ok = fn();
+  double ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()-begin_s).count() / 1000.0;
+  Logger::metric(kv, stage + "_ms", ms);
+  // the worker of the isolated mode reports the timings with the item only
+  if (Isolation::inChild())
+    return ok;
+  Logger::metrics stageKv;
+  Logger::metric(stageKv, "ok", ok);
+  Log.log(ok ? Logger::INFO : Logger::ERROR, modelFilePath.string(), stage, ms, "", stageKv);
+  return ok;
+}
+
+template <typename T>
+std::vector<T> parseList(std::string list) {
+  // comma separated values of a sweep flag
+  std::vector<std::string> parts = splitString(list, ",");
+  std::vector<T> values;
+  for (std::size_t k = 0; k < parts.size(); ++k)
+    values.push_back(boost::lexical_cast<T>(parts[k]));
+  return values;
+}
+
+bool parsePlanes(std::string list, std::vector<slicePlane>& planes) {
+  // comma separated planes <x|y|z|nx/ny/nz><+|->[:offset], + keeps the half the normal points into
+  std::vector<std::string> parts = splitString(list, ",");
+  for (std::size_t k = 0; k < parts.size(); ++k) {
+    std::string spec = parts[k], dir;
+    slicePlane sp;
+    sp.offset = 0;
+    std::size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+      sp.offset = atof(spec.substr(colon + 1).c_str());
+      spec = spec.substr(0, colon);
+    }
+    if (spec.size() < 2 || (spec.back() != '+' && spec.back() != '-')) {
+      std::cerr << "Flag: --planes " << parts[k] << " has no side + or -\n";
+      return false;
+    }
+    double side = spec.back() == '+' ? 1 : -1;
+    dir = spec.substr(0, spec.size() - 1);
+    std::vector<std::string> comps = splitString(dir, "/");
+    if (dir == "x" || dir == "y" || dir == "z") {
+      for (int c = 0; c < 3; ++c)
+        sp.n[c] = (dir[0] - 'x' == c) ? 1 : 0;
+      sp.tag = dir + (side > 0 ? "p" : "n");
+    }
+    else if (comps.size() == 3) {
+      for (int c = 0; c < 3; ++c)
+        sp.n[c] = atof(comps[c].c_str());
+      sp.tag = "plane" + std::to_string(k) + (side > 0 ? "p" : "n");
+    }
+    else {
+      std::cerr << "Flag: --planes " << parts[k] << " is neither an axis nor a normal nx/ny/nz\n";
+      return false;
+    }
+    double len = std::sqrt(sp.n[0] * sp.n[0] + sp.n[1] * sp.n[1] + sp.n[2] * sp.n[2]);
+    if (len <= 0) {
+      std::cerr << "Flag: --planes " << parts[k] << " has a zero normal\n";
+      return false;
+    }
+    // the offset is along the given normal, the kept side may flip it
+    sp.offset *= side;
+    for (int c = 0; c < 3; ++c)
+      sp.n[c] *= side / len;
+    if (colon != std::string::npos && dir.size() == 1)
+      sp.tag = "plane" + std::to_string(k) + (side > 0 ? "p" : "n");
+    planes.push_back(sp);
+  }
+  return true;
+}
+
 bool getFlags(char * argv[], int argc) {
   std::vector<std::string> args(argv, argv + argc);
   for (int i = 3; i < args.size(); ++i) {
@@ -130,20 +392,113 @@ bool getFlags(char * argv[], int argc) {
       Paths.fldPre = argv[++i];
     else if (argv[i] == std::string("--flStr"))
       Paths.flStr = argv[++i];
+    else if (argv[i] == std::string("--watch"))
+      Flag.watch = argv[++i];
+    else if (argv[i] == std::string("--watchDebounceMs"))
+      Flag.watchDebounceMs = std::max(0, atoi(argv[++i]));
+    else if (argv[i] == std::string("--dedup"))
+      Flag.dedup = atof(argv[++i]);
     else if (argv[i] == std::string("--slice"))
       Flag.slice = true;
+    else if (argv[i] == std::string("--planes")) {
+      if (!parsePlanes(argv[++i], Flag.planes))
+        return false;
+    }
+    else if (argv[i] == std::string("--reorder"))
+      Flag.reorder = true;
     else if (argv[i] == std::string("--sPI")) {
       Flag.sPI = true;
       Flag.sPIterations = atoi(argv[++i]);
     }
+    else if (argv[i] == std::string("--param")) {
+      Flag.param = argv[++i];
+      if (Flag.param != "fast" && Flag.param != "authalic" && Flag.param != "multilevel") {
+        std::cerr << "Flag: --param " << Flag.param << " is neither fast, authalic nor multilevel\n";
+        return false;
+      }
+    }
+    else if (argv[i] == std::string("--mlMin"))
+      Flag.mlMinVertices = std::max(3, atoi(argv[++i]));
+    else if (argv[i] == std::string("--mlIter"))
+      Flag.mlIter = std::max(0, atoi(argv[++i]));
     else if (argv[i] == std::string("--m2G")) {
       Flag.m2G = true;
       Flag.im_size = atoi(argv[++i]);
     }
     else if (argv[i] == std::string("--useNormal"))
       Flag.useNormal = true;
+    else if (argv[i] == std::string("--curvGI"))
+      Flag.curvGI = true;
+    else if (argv[i] == std::string("--colorGI"))
+      Flag.colorGI = true;
+    else if (argv[i] == std::string("--labelGI"))
+      Flag.labelGI = true;
+    else if (argv[i] == std::string("--maskGI"))
+      Flag.maskGI = true;
+    else if (argv[i] == std::string("--maskNormal")) {
+      Flag.maskNormal = true;
+      Flag.useNormal = true;
+    }
+    else if (argv[i] == std::string("--gather"))
+      Flag.gather = true;
+    else if (argv[i] == std::string("--sampleMap"))
+      Flag.sampleMap = true;
+    else if (argv[i] == std::string("--vertexTable"))
+      Flag.vertexTable = true;
+    else if (argv[i] == std::string("--applyGI")) {
+      Flag.applyGI = argv[++i];
+      Flag.vertexTable = true;
+    }
+    else if (argv[i] == std::string("--stream"))
+      Flag.stream = std::max(0, atoi(argv[++i]));
+    else if (argv[i] == std::string("--gatherCheck")) {
+      Flag.gather = true;
+      Flag.gatherCheck = true;
+    }
+    else if (argv[i] == std::string("--prefetch"))
+      Flag.prefetch = atoi(argv[++i]);
+    else if (argv[i] == std::string("--prefetchMB"))
+      Flag.prefetchMB = atoi(argv[++i]);
+    else if (argv[i] == std::string("--jsonl"))
+      Flag.jsonl = true;
+    else if (argv[i] == std::string("--progressMs"))
+      Flag.progressMs = atoi(argv[++i]);
+    else if (argv[i] == std::string("--pack"))
+      Flag.pack = true;
+    else if (argv[i] == std::string("--isolate"))
+      Flag.isolate = true;
+    else if (argv[i] == std::string("--isolateBatch"))
+      Flag.isolateBatch = atoi(argv[++i]);
+    else if (argv[i] == std::string("--timeout"))
+      Flag.timeout = atoi(argv[++i]);
+    else if (argv[i] == std::string("--memMB"))
+      Flag.memMB = atoi(argv[++i]);
+    else if (argv[i] == std::string("--refineDensity"))
+      Flag.refineDensity = atof(argv[++i]);
+    else if (argv[i] == std::string("--fillIter"))
+      Flag.fillIter = atoi(argv[++i]);
+    else if (argv[i] == std::string("--sweep"))
+      Flag.sweep = true;
+    else if (argv[i] == std::string("--sweepIter"))
+      Flag.sweepIter = parseList<int>(argv[++i]);
+    else if (argv[i] == std::string("--sweepSize"))
+      Flag.sweepSize = parseList<int>(argv[++i]);
+    else if (argv[i] == std::string("--sweepRefine"))
+      Flag.sweepRefine = parseList<double>(argv[++i]);
+    else if (argv[i] == std::string("--sweepFill"))
+      Flag.sweepFill = parseList<int>(argv[++i]);
+    else if (argv[i] == std::string("--sweepBar"))
+      Flag.sweepBar = atof(argv[++i]);
+    else if (argv[i] == std::string("--giStats"))
+      Flag.giStats = argv[++i];
+    else if (argv[i] == std::string("--mergeStats"))
+      Flag.mergeStats = parseList<std::string>(argv[++i]);
     else if (argv[i] == std::string("--G2o"))
       Flag.G2o = true;
+    else if (argv[i] == std::string("--weld"))
+      Flag.weld = atof(argv[++i]);
+    else if (argv[i] == std::string("--mirror"))
+      Flag.mirror = true;
     else  {
       std::cerr << "Flag: " << argv[i] << " not defined in program\n";
       return false;
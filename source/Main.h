@@ -14,12 +14,24 @@
 #include "Texter.h"
 #include "Preprocess.h"
 #include "Parameterization.h"
+#include "Prefetcher.h"
+#include "Isolation.h"
+#include "Sweep.h"
+#include "Dedup.h"
+#include "Watcher.h"
+#include "Pack.h"
+#include "Simd.h"
+
+#include <functional>
 
 bool getFlags (char * argv[], int argc);
+void stopWatch(int);
+void removeStale(fs::path input, fs::path outputPath);
+bool runStage(std::string stage, fs::path& modelFilePath, std::function<bool()> fn, Logger::metrics& kv);
 
 flag Flag;
 paths Paths;
-std::ofstream LogFile;  // report log file
-std::stringstream LogSS;  // log stringstream
+Logger Log; // asynchronous report log
+volatile sig_atomic_t watchStopped = 0;  // set by SIGINT or SIGTERM in the watch mode
 
 #endif /* MAIN_H_ */
@@ -0,0 +1,201 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "MeshStream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MeshStream::nextLine(std::istream& in, std::string& line) {
+  while (std::getline(in, line)) {
+    std::size_t hash = line.find('#');
+    if (hash != std::string::npos)
+      line.erase(hash);
+    if (line.find_first_not_of(" \t\r") != std::string::npos)
+      return true;
+  }
+  return false;
+}
+
+bool MeshStream::readHeader(std::istream& in, std::size_t& nV, std::size_t& nF) {
+  std::string line, keyword;
+  if (!nextLine(in, line))
+    return false;
+  std::istringstream ss(line);
+  ss >> keyword;
+  if (keyword.size() < 3 || keyword.compare(keyword.size() - 3, 3, "OFF") != 0)
+    return false;
+  if (!(ss >> nV >> nF)) {
+    if (!nextLine(in, line))
+      return false;
+    std::istringstream counts(line);
+    if (!(counts >> nV >> nF))
+      return false;
+  }
+  return true;
+}
+
+MeshStream::MeshStream(): data(NULL), size(0), nV(0), nF(0), V(NULL), F(NULL) {
+}
+
+MeshStream::~MeshStream() {
+  close();
+}
+
+bool MeshStream::pack(fs::path mesh3D, fs::path mesh2D, fs::path binFile, std::stringstream& LogFile) {
+  fs::ifstream in3(mesh3D), in2(mesh2D);
+  if (!in3 || !in2) {
+    std::cerr << "  Couldn't open " << (in3 ? mesh2D : mesh3D) << " to stream\n";
+    LogFile << "Couldn't open " << (in3 ? mesh2D : mesh3D) << " to stream\n";
+    return false;
+  }
+  std::size_t nV3, nF3, nV2, nF2;
+  if (!readHeader(in3, nV3, nF3) || !readHeader(in2, nV2, nF2)) {
+    std::cerr << "  Only OFF meshes can be streamed\n";
+    LogFile << "Only OFF meshes can be streamed\n";
+    return false;
+  }
+  // the parameterized mesh has the vertices of the 3D mesh in the same order
+  if (nV3 != nV2) {
+    std::cerr << "  Mesh_2D.nv != mesh_3D.nv" << std::endl;
+    LogFile << "  Mesh_2D.nv != mesh_3D.nv" << std::endl;
+    return false;
+  }
+
+  // written to a temporary name first, an interrupted pack never leaves a valid looking file
+  fs::path tmpFile = binFile.string() + ".tmp";
+  std::ofstream out(tmpFile.string().c_str(), std::ios::binary);
+  if (!out) {
+    std::cerr << "  Couldn't open " << tmpFile << " to write\n";
+    LogFile << "Couldn't open " << tmpFile << " to write\n";
+    return false;
+  }
+  header h = { { 'L', 'S', 'S', 'B' }, 1, nV2, nF2 };
+  out.write((const char*) &h, sizeof(h));
+  bool ok = writeRecords(in3, in2, nV2, nF2, out, LogFile);
+  out.close();
+  if (ok && !out) {
+    std::cerr << "  Couldn't write " << tmpFile << "\n";
+    LogFile << "Couldn't write " << tmpFile << "\n";
+    ok = false;
+  }
+  if (!ok) {
+    boost::system::error_code ec;
+    fs::remove(tmpFile, ec);
+    return false;
+  }
+  fs::rename(tmpFile, binFile);
+  return true;
+}
+
+bool MeshStream::open(fs::path binFile, std::stringstream& LogFile) {
+  close();
+  int fd = ::open(binFile.string().c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || (std::size_t) st.st_size < sizeof(header)) {
+    if (fd >= 0)
+      ::close(fd);
+    std::cerr << "  Couldn't open " << binFile << " to stream\n";
+    LogFile << "Couldn't open " << binFile << " to stream\n";
+    return false;
+  }
+  size = st.st_size;
+  data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    data = NULL;
+    std::cerr << "  Couldn't map " << binFile << "\n";
+    LogFile << "Couldn't map " << binFile << "\n";
+    return false;
+  }
+
+  const header* h = (const header*) data;
+  if (std::string(h->magic, 4) != "LSSB" || h->version != 1 ||
+      size != sizeof(header) + h->nV * RECORD * sizeof(float) + h->nF * 3 * sizeof(int32_t)) {
+    close();
+    std::cerr << "  " << binFile << " is not a packed mesh\n";
+    LogFile << binFile << " is not a packed mesh\n";
+    return false;
+  }
+  nV = h->nV;
+  nF = h->nF;
+  V = (const float*) ((const char*) data + sizeof(header));
+  F = (const int32_t*) (V + nV * RECORD);
+  // faces are read front to back, vertices wherever the faces point
+  madvise(data, size, MADV_RANDOM);
+  return true;
+}
+
+void MeshStream::close() {
+  if (data)
+    munmap(data, size);
+  data = NULL;
+  size = nV = nF = 0;
+  V = NULL;
+  F = NULL;
+}
+
+void MeshStream::release() {
+  // the mapping is read only, dropped pages are read again from the file when touched
+  if (data)
+    madvise(data, size, MADV_DONTNEED);
+}
+
+
+// private
+bool MeshStream::writeRecords(std::istream& in3, std::istream& in2, std::size_t nV, std::size_t nF, std::ostream& out, std::stringstream& LogFile) {
+  std::string line3, line2;
+  for (std::size_t i = 0; i < nV; ++i) {
+    float rec[RECORD];
+    if (!nextLine(in3, line3) || !nextLine(in2, line2)) {
+      std::cerr << "  Fewer vertices than in the header\n";
+      LogFile << "Fewer vertices than in the header\n";
+      return false;
+    }
+    std::istringstream ss3(line3), ss2(line2);
+    if (!(ss2 >> rec[0] >> rec[1]) || !(ss3 >> rec[2] >> rec[3] >> rec[4])) {
+      std::cerr << "  Vertex " << i << " couldn't be parsed\n";
+      LogFile << "Vertex " << i << " couldn't be parsed\n";
+      return false;
+    }
+    // check if Mesh_2D has any vertex which is an outlier
+    if (std::abs(rec[0]) > 1.5 || std::abs(rec[1]) > 1.5) {
+      std::cerr << " " << i << "(" << rec[0] << "," << rec[1] << ")" << std::endl;
+      LogFile << " " << i << "(" << rec[0] << "," << rec[1] << ")" << std::endl;
+      return false;
+    }
+    out.write((const char*) rec, sizeof(rec));
+  }
+  for (std::size_t f = 0; f < nF; ++f) {
+    int n = 0;
+    int32_t idx[3];
+    if (!nextLine(in2, line2)) {
+      std::cerr << "  Fewer faces than in the header\n";
+      LogFile << "Fewer faces than in the header\n";
+      return false;
+    }
+    std::istringstream ss(line2);
+    if (!(ss >> n >> idx[0] >> idx[1] >> idx[2]) || n != 3) {
+      std::cerr << "  Only triangles can be streamed\n";
+      LogFile << "Only triangles can be streamed\n";
+      return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+      if (idx[k] < 0 || (std::size_t) idx[k] >= nV) {
+        std::cerr << "  Face " << f << " has an invalid vertex\n";
+        LogFile << "Face " << f << " has an invalid vertex\n";
+        return false;
+      }
+    }
+    out.write((const char*) idx, sizeof(idx));
+  }
+  return true;
+}
@@ -0,0 +1,56 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef MESHSTREAM_H_
+#define MESHSTREAM_H_
+
+#include "include.h"
+
+// Binary pairing of a 3D mesh and its parameterization for out-of-core rasterization. pack()
+// reads the two OFF files line by line in lockstep, so no mesh is ever held in memory, and
+// writes one record u,v,x,y,z per vertex followed by the triangles. open() maps the file; the
+// faces are then read in chunks and release() drops the mapped pages after each chunk, so the
+// resident memory stays bounded by the chunk instead of growing with the mesh.
+class MeshStream {
+public:
+  enum { RECORD = 5 }; // floats per vertex: u, v, x, y, z
+
+  MeshStream();
+  virtual ~MeshStream();
+  static bool pack(fs::path mesh3D, fs::path mesh2D, fs::path binFile, std::stringstream& LogFile);
+  bool open(fs::path binFile, std::stringstream& LogFile);
+  void close();
+  void release();
+  std::size_t nVertices() const { return nV; }
+  std::size_t nFaces() const { return nF; }
+  const float* vertex(int i) const { return V + (std::size_t) i * RECORD; }
+  const int32_t* face(std::size_t f) const { return F + f * 3; }
+  // next line which is neither empty nor a comment, with a trailing comment removed
+  static bool nextLine(std::istream& in, std::string& line);
+  // OFF header with the counts either on the keyword line or on the next one
+  static bool readHeader(std::istream& in, std::size_t& nV, std::size_t& nF);
+
+private:
+  // vertex and face records of the two meshes after their headers
+  static bool writeRecords(std::istream& in3, std::istream& in2, std::size_t nV, std::size_t nF, std::ostream& out, std::stringstream& LogFile);
+
+  struct header {
+    char magic[4];  // LSSB
+    uint32_t version;
+    uint64_t nV, nF;
+  };
+
+  void* data; // mapped file
+  std::size_t size;
+  std::size_t nV, nF;
+  const float* V;
+  const int32_t* F;
+};
+
+#endif /* MESHSTREAM_H_ */
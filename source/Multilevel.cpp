@@ -0,0 +1,252 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Multilevel.h"
+
+Multilevel::Multilevel(std::stringstream& LogFile, int minVertices, int nIter):
+  LogFile(LogFile), minVertices(minVertices), nIter(nIter) {
+}
+
+Multilevel::~Multilevel() {
+  // TODO Auto-generated destructor stub
+}
+
+SMP::Error_code Multilevel::parameterize(Surface_mesh& sm, halfedge_descriptor bhd, SM_uvmap uv_map, int& iterations, double& error) {
+  buildHierarchy(sm);
+  LogFile << "multilevel," << levels.size() + 1;
+  for (std::size_t l = 0; l < levels.size(); ++l)
+    LogFile << "," << levels[l].number_of_vertices();
+  LogFile << std::endl;
+
+  // the border halfedge of the slice is a border halfedge of every level, the square border
+  // is therefore laid out as without the hierarchy
+  Surface_mesh& coarsest = levels.empty() ? sm : levels.back();
+  halfedge_descriptor coarse_bhd = bhd;
+  if (!levels.empty()) {
+    Surface_mesh::Property_map<halfedge_descriptor, halfedge_descriptor> slice_hd =
+        coarsest.property_map<halfedge_descriptor, halfedge_descriptor>("h:slice").first;
+    BOOST_FOREACH(halfedge_descriptor hd, halfedges(coarsest)) {
+      if (get(slice_hd, hd) == bhd)
+        coarse_bhd = hd;
+    }
+  }
+  SM_uvmap coarse_uv = coarsest.add_property_map<vertex_descriptor, Point_2>("v:uv").first;
+  Border_parameterizer border_param;
+  SMP::Error_code err = SMP::parameterize(coarsest, Parameterizer(border_param), coarse_bhd, coarse_uv, iterations, error);
+  if (err != SMP::OK || levels.empty()) {
+    levels.clear();
+    return err;
+  }
+
+  // a level is dropped once its uv is carried up
+  for (int l = (int) levels.size() - 1; l >= 0; --l) {
+    Surface_mesh& fine = l ? levels[l - 1] : sm;
+    SM_uvmap fine_uv = l ? fine.add_property_map<vertex_descriptor, Point_2>("v:uv").first : uv_map;
+    prolong(levels[l], fine, fine_uv);
+    levels.pop_back();
+    for (int it = 0; it < nIter; ++it) {
+      if (!refine(fine, fine_uv)) {
+        levels.clear();
+        return SMP::ERROR_CANNOT_SOLVE_LINEAR_SYSTEM;
+      }
+    }
+  }
+  // the residual of the iterative parameterizer on the coarsest level no longer describes
+  // the slice, report the area distortion of the final uv instead
+  error = distortion(sm, uv_map);
+  return SMP::OK;
+}
+
+
+// private
+void Multilevel::buildHierarchy(const Surface_mesh& sm) {
+  // each level keeps about a quarter of the edges of the finer one, the hierarchy ends at
+  // minVertices or when the border leaves nothing to collapse. The collapses leave removed
+  // elements behind, each level is compacted so that it only holds the simplified mesh and
+  // the index maps prolong and parameterize need
+  levels.clear();
+  levels.reserve(16);
+  const Surface_mesh* fine = &sm;
+  while ((int) fine->number_of_vertices() > minVertices && levels.size() < 16) {
+    levels.push_back(*fine);
+    Surface_mesh& coarse = levels.back();
+    Surface_mesh::Property_map<vertex_descriptor, vertex_descriptor> fine_vd =
+        coarse.add_property_map<vertex_descriptor, vertex_descriptor>("v:fine").first;
+    BOOST_FOREACH(vertex_descriptor vd, vertices(coarse))
+      put(fine_vd, vd, vd);
+    Surface_mesh::Property_map<halfedge_descriptor, halfedge_descriptor> slice_hd;
+    bool created;
+    boost::tie(slice_hd, created) = coarse.add_property_map<halfedge_descriptor, halfedge_descriptor>("h:slice");
+    if (created) {
+      BOOST_FOREACH(halfedge_descriptor hd, halfedges(coarse))
+        put(slice_hd, hd, hd);
+    }
+    Border_is_constrained_edge_map bem(coarse);
+    SMS::Count_ratio_stop_predicate<Surface_mesh> stop(0.25);
+    SMS::Constrained_placement<SMS::Midpoint_placement<Surface_mesh>, Border_is_constrained_edge_map> placement(bem);
+    SMS::edge_collapse(coarse, stop, CGAL::parameters::edge_is_constrained_map(bem).get_placement(placement));
+    if (coarse.number_of_vertices() > 0.9 * fine->number_of_vertices()) {
+      levels.pop_back();
+      break;
+    }
+    coarse.collect_garbage();
+    fine = &coarse;
+  }
+}
+
+void Multilevel::prolong(const Surface_mesh& coarse, Surface_mesh& fine, SM_uvmap fine_uv) {
+  SM_uvmap coarse_uv = coarse.property_map<vertex_descriptor, Point_2>("v:uv").first;
+  Surface_mesh::Property_map<vertex_descriptor, vertex_descriptor> fine_vd =
+      coarse.property_map<vertex_descriptor, vertex_descriptor>("v:fine").first;
+  std::vector<bool> kept(fine.num_vertices(), false);
+  BOOST_FOREACH(vertex_descriptor vd, vertices(coarse)) {
+    put(fine_uv, get(fine_vd, vd), get(coarse_uv, vd));
+    kept[get(fine_vd, vd)] = true;
+  }
+  AABB_tree tree(faces(coarse).first, faces(coarse).second, coarse);
+  tree.accelerate_distance_queries();
+  BOOST_FOREACH(vertex_descriptor vd, vertices(fine)) {
+    if (kept[vd])
+      continue;
+    // barycentric coordinates of the closest point in the closest coarse face
+    AABB_tree::Point_and_primitive_id pp = tree.closest_point_and_primitive(fine.point(vd));
+    halfedge_descriptor hd = halfedge(pp.second, coarse);
+    vertex_descriptor v[3] = { source(hd, coarse), target(hd, coarse), target(next(hd, coarse), coarse) };
+    Kernel::Vector_3 e0 = coarse.point(v[1]) - coarse.point(v[0]);
+    Kernel::Vector_3 e1 = coarse.point(v[2]) - coarse.point(v[0]);
+    Kernel::Vector_3 e2 = pp.first - coarse.point(v[0]);
+    double d00 = CGAL::to_double(e0 * e0), d01 = CGAL::to_double(e0 * e1), d11 = CGAL::to_double(e1 * e1);
+    double d20 = CGAL::to_double(e2 * e0), d21 = CGAL::to_double(e2 * e1);
+    double den = d00 * d11 - d01 * d01;
+    double b1 = den > 0 ? (d11 * d20 - d01 * d21) / den : 1.0 / 3;
+    double b2 = den > 0 ? (d00 * d21 - d01 * d20) / den : 1.0 / 3;
+    b1 = std::max(0.0, std::min(1.0, b1));
+    b2 = std::max(0.0, std::min(1.0 - b1, b2));
+    double b0 = 1 - b1 - b2;
+    Point_2 q[3] = { get(coarse_uv, v[0]), get(coarse_uv, v[1]), get(coarse_uv, v[2]) };
+    put(fine_uv, vd, Point_2(b0 * CGAL::to_double(q[0].x()) + b1 * CGAL::to_double(q[1].x()) + b2 * CGAL::to_double(q[2].x()),
+        b0 * CGAL::to_double(q[0].y()) + b1 * CGAL::to_double(q[1].y()) + b2 * CGAL::to_double(q[2].y())));
+  }
+}
+
+bool Multilevel::refine(Surface_mesh& sm, SM_uvmap uv_map) {
+  // relative area of the 1-ring in uv over that in 3D, above 1 where uv is stretched
+  std::vector<double> A3(sm.num_vertices(), 0), A2(sm.num_vertices(), 0);
+  double sum3 = 0, sum2 = 0;
+  BOOST_FOREACH(face_descriptor fd, faces(sm)) {
+    halfedge_descriptor hd = halfedge(fd, sm);
+    vertex_descriptor v[3] = { source(hd, sm), target(hd, sm), target(next(hd, sm), sm) };
+    double a3 = std::sqrt(CGAL::to_double(CGAL::squared_area(sm.point(v[0]), sm.point(v[1]), sm.point(v[2]))));
+    double a2 = std::abs(CGAL::to_double(CGAL::area(get(uv_map, v[0]), get(uv_map, v[1]), get(uv_map, v[2]))));
+    for (int k = 0; k < 3; ++k) {
+      A3[v[k]] += a3;
+      A2[v[k]] += a2;
+    }
+    sum3 += a3;
+    sum2 += a2;
+  }
+
+  std::vector<int> idx(sm.num_vertices(), -1);
+  int n = 0;
+  BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+    if (!is_border(vd, sm))
+      idx[vd] = n++;
+  }
+  if (n == 0)
+    return true;
+
+  // authalic system of the interior vertices, the weight of a neighbour grows with the
+  // stretch around it so that a stretched region contracts, as in the iterative parameterizer
+  std::vector<Eigen::Triplet<double> > triplets;
+  Eigen::VectorXd bu = Eigen::VectorXd::Zero(n), bv = Eigen::VectorXd::Zero(n);
+  Eigen::VectorXd xu(n), xv(n);
+  BOOST_FOREACH(vertex_descriptor vi, vertices(sm)) {
+    int i = idx[vi];
+    if (i < 0)
+      continue;
+    xu[i] = CGAL::to_double(get(uv_map, vi).x());
+    xv[i] = CGAL::to_double(get(uv_map, vi).y());
+    double diag = 0;
+    BOOST_FOREACH(halfedge_descriptor hd, halfedges_around_target(vi, sm)) {
+      vertex_descriptor vj = source(hd, sm);
+      double stretch = (A3[vj] > 0 && sum2 > 0) ? (A2[vj] / sum2) / (A3[vj] / sum3) : 1;
+      double w = weight(sm, hd) * std::sqrt(stretch);
+      diag += w;
+      if (idx[vj] >= 0)
+        triplets.push_back(Eigen::Triplet<double>(i, idx[vj], -w));
+      else {
+        bu[i] += w * CGAL::to_double(get(uv_map, vj).x());
+        bv[i] += w * CGAL::to_double(get(uv_map, vj).y());
+      }
+    }
+    triplets.push_back(Eigen::Triplet<double>(i, i, diag));
+  }
+  Eigen::SparseMatrix<double> A(n, n);
+  A.setFromTriplets(triplets.begin(), triplets.end());
+
+  // the current uv is the initial guess, from a good guess the solver converges in few steps
+  Eigen::BiCGSTAB<Eigen::SparseMatrix<double> > solver;
+  solver.compute(A);
+  Eigen::VectorXd u = solver.solveWithGuess(bu, xu);
+  if (solver.info() != Eigen::Success)
+    return false;
+  Eigen::VectorXd v = solver.solveWithGuess(bv, xv);
+  if (solver.info() != Eigen::Success)
+    return false;
+
+  BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+    int i = idx[vd];
+    if (i >= 0)
+      put(uv_map, vd, Point_2(u[i], v[i]));
+  }
+  return true;
+}
+
+double Multilevel::distortion(const Surface_mesh& sm, SM_uvmap uv_map) {
+  // summed difference of the relative face areas in uv and in 3D, the measure the iterative
+  // authalic parameterizer minimizes
+  std::vector<double> a3, a2;
+  double sum3 = 0, sum2 = 0;
+  BOOST_FOREACH(face_descriptor fd, faces(sm)) {
+    halfedge_descriptor hd = halfedge(fd, sm);
+    vertex_descriptor v[3] = { source(hd, sm), target(hd, sm), target(next(hd, sm), sm) };
+    a3.push_back(std::sqrt(CGAL::to_double(CGAL::squared_area(sm.point(v[0]), sm.point(v[1]), sm.point(v[2])))));
+    a2.push_back(std::abs(CGAL::to_double(CGAL::area(get(uv_map, v[0]), get(uv_map, v[1]), get(uv_map, v[2])))));
+    sum3 += a3.back();
+    sum2 += a2.back();
+  }
+  if (sum3 <= 0 || sum2 <= 0)
+    return 0;
+  double err = 0;
+  for (std::size_t f = 0; f < a3.size(); ++f)
+    err += std::abs(a2[f] / sum2 - a3[f] / sum3);
+  return err;
+}
+
+double Multilevel::weight(const Surface_mesh& sm, halfedge_descriptor h) {
+  // discrete authalic weight of the edge from source j to target i: the cotangents of the
+  // angles at j opposite to the two faces, over the squared edge length; weights of obtuse
+  // configurations are clamped positive to keep the map an embedding
+  vertex_descriptor vi = target(h, sm), vj = source(h, sm);
+  Kernel::Vector_3 eij = sm.point(vi) - sm.point(vj);
+  double len2 = CGAL::to_double(eij.squared_length());
+  if (len2 <= 0)
+    return 0;
+  double cot = 0;
+  halfedge_descriptor hs[2] = { h, opposite(h, sm) };
+  for (int s = 0; s < 2; ++s) {
+    if (is_border(hs[s], sm))
+      continue;
+    Kernel::Vector_3 ejk = sm.point(target(next(hs[s], sm), sm)) - sm.point(vj);
+    double cross = std::sqrt(CGAL::to_double(CGAL::cross_product(eij, ejk).squared_length()));
+    if (cross > 0)
+      cot += CGAL::to_double(eij * ejk) / cross;
+  }
+  return std::max(cot, 1e-6) / len2;
+}
@@ -0,0 +1,63 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef MULTILEVEL_H_
+#define MULTILEVEL_H_
+
+#include "include.h"
+#include "Parameterization.h"
+
+#include <CGAL/Surface_mesh_simplification/edge_collapse.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Count_ratio_stop_predicate.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Midpoint_placement.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Constrained_placement.h>
+namespace SMS = CGAL::Surface_mesh_simplification;
+
+#include <Eigen/Sparse>
+
+// Coarse to fine parameterization of a slice. The slice is simplified by edge collapses with
+// its border edges constrained, so every level keeps the border vertices. Levels are garbage
+// collected after the collapses; each coarse vertex records in "v:fine" its index in the finer
+// level, and each halfedge in "h:slice" its index in the slice. The coarsest level is
+// parameterized by the iterative authalic parameterizer, its uv is then carried up: the
+// vertices kept from the coarser level start at their coarse uv, the collapsed ones at the uv
+// interpolated in the closest coarse face. A few authalic solves, reweighted by the area
+// stretch of the current uv and started from it, refine every finer level.
+class Multilevel {
+public:
+  Multilevel(std::stringstream& LogFile, int minVertices, int nIter);
+  virtual ~Multilevel();
+  SMP::Error_code parameterize(Surface_mesh& sm, halfedge_descriptor bhd, SM_uvmap uv_map, int& iterations, double& error);
+
+private:
+  // border edges are never collapsed
+  struct Border_is_constrained_edge_map {
+    const Surface_mesh* sm;
+    typedef edge_descriptor key_type;
+    typedef bool value_type;
+    typedef value_type reference;
+    typedef boost::readable_property_map_tag category;
+    Border_is_constrained_edge_map() : sm(NULL) {}
+    Border_is_constrained_edge_map(const Surface_mesh& sm) : sm(&sm) {}
+    friend value_type get(const Border_is_constrained_edge_map& m, const key_type& e) { return CGAL::is_border(e, *m.sm); }
+  };
+
+  void buildHierarchy(const Surface_mesh& sm);
+  void prolong(const Surface_mesh& coarse, Surface_mesh& fine, SM_uvmap fine_uv);
+  bool refine(Surface_mesh& sm, SM_uvmap uv_map);
+  double distortion(const Surface_mesh& sm, SM_uvmap uv_map);
+  double weight(const Surface_mesh& sm, halfedge_descriptor h);
+
+  std::stringstream& LogFile;
+  int minVertices;  // vertices of the coarsest level
+  int nIter;  // reweighted solves per finer level
+  std::vector<Surface_mesh> levels; // simplifications of the slice, coarsest last
+};
+
+#endif /* MULTILEVEL_H_ */
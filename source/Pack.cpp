@@ -0,0 +1,286 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Pack.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+std::string Pack::writeDir;
+
+namespace {
+std::mutex registryMtx;
+std::map<std::string, std::shared_ptr<Pack> > registry; // folder -> its pack, null if it has none
+
+std::string folderKey(const fs::path& dir) {
+  std::string key = dir.string();
+  while (key.size() > 1 && key[key.size() - 1] == '/')
+    key.erase(key.size() - 1);
+  return key;
+}
+
+bool preadAll(int fd, char* buf, std::size_t n, uint64_t offset) {
+  while (n > 0) {
+    ssize_t r = pread(fd, buf, n, offset);
+    if (r <= 0)
+      return false;
+    buf += r;
+    n -= r;
+    offset += r;
+  }
+  return true;
+}
+
+bool pwriteAll(int fd, const char* buf, std::size_t n, uint64_t offset) {
+  while (n > 0) {
+    ssize_t w = pwrite(fd, buf, n, offset);
+    if (w <= 0)
+      return false;
+    buf += w;
+    n -= w;
+    offset += w;
+  }
+  return true;
+}
+
+uint64_t fileSize(int fd) {
+  struct stat st;
+  return fstat(fd, &st) == 0 ? st.st_size : 0;
+}
+
+std::shared_ptr<Pack> find(const fs::path& file, bool create) {
+  std::string key = folderKey(file.parent_path());
+  std::lock_guard<std::mutex> lock(registryMtx);
+  std::map<std::string, std::shared_ptr<Pack> >::iterator it = registry.find(key);
+  if (it != registry.end() && (it->second || !create))
+    return it->second;
+  // a folder is looked up once, later files of it are answered from the registry
+  std::shared_ptr<Pack> P(new Pack);
+  if (!P->open(key.empty() ? fs::path(".") : fs::path(key), create))
+    P.reset();
+  registry[key] = P;
+  return P;
+}
+}
+
+Pack::Pack(): dataFd(-1), indexFd(-1), indexRead(0), dataEnd(0) {
+}
+
+Pack::~Pack() {
+  if (dataFd >= 0)
+    close(dataFd);
+  if (indexFd >= 0)
+    close(indexFd);
+}
+
+bool Pack::open(fs::path dir, bool create) {
+  this->dir = dir;
+  fs::path dataFile = dir / "pack.lssp", indexFile = dir / "pack.lssi";
+  if (!create && !fs::exists(dataFile))
+    return false;
+  dataFd = ::open(dataFile.string().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  indexFd = ::open(indexFile.string().c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (dataFd < 0 || indexFd < 0) {
+    std::cerr << "Couldn't open the pack of " << dir << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(mtx);
+  if (!lock())
+    return false;
+  refresh();
+  recover();
+  unlock();
+  return true;
+}
+
+bool Pack::has(const std::string& name, std::size_t minSize) {
+  std::lock_guard<std::mutex> guard(mtx);
+  std::map<std::string, entry>::iterator it = index.find(name);
+  if (it == index.end()) {
+    // another worker may have written it since the index was read
+    refresh();
+    it = index.find(name);
+  }
+  return it != index.end() && it->second.rawSize > minSize;
+}
+
+bool Pack::get(const std::string& name, std::string& bytes) {
+  entry e;
+  {
+    std::lock_guard<std::mutex> guard(mtx);
+    std::map<std::string, entry>::iterator it = index.find(name);
+    if (it == index.end()) {
+      refresh();
+      it = index.find(name);
+      if (it == index.end())
+        return false;
+    }
+    e = it->second;
+  }
+  // records are never changed once they are in the index, so they are read without a lock
+  std::string payload(e.size, '\0');
+  if (e.size > 0 && !preadAll(dataFd, &payload[0], e.size, e.offset)) {
+    std::cerr << "Couldn't read " << name << " from the pack of " << dir << "\n";
+    return false;
+  }
+  if (e.flags != DEFLATED) {
+    bytes.swap(payload);
+    return true;
+  }
+  bytes.resize(e.rawSize);
+  uLongf rawSize = e.rawSize;
+  if (uncompress((Bytef*) &bytes[0], &rawSize, (const Bytef*) payload.data(), payload.size()) != Z_OK || rawSize != e.rawSize) {
+    std::cerr << "Couldn't inflate " << name << " from the pack of " << dir << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool Pack::put(const std::string& name, const std::string& bytes) {
+  // deflated with the fastest level, the outputs are written once and read a few times
+  uLongf size = compressBound(bytes.size());
+  std::string payload(size, '\0');
+  if (compress2((Bytef*) &payload[0], &size, (const Bytef*) bytes.data(), bytes.size(), Z_BEST_SPEED) == Z_OK && size < bytes.size()) {
+    payload.resize(size);
+    return append(name, DEFLATED, bytes.size(), payload);
+  }
+  return append(name, STORED, bytes.size(), bytes);
+}
+
+bool Pack::erase(const std::string& name) {
+  if (!has(name))
+    return true;
+  return append(name, ERASED, 0, std::string());
+}
+
+std::vector<std::string> Pack::names() {
+  std::lock_guard<std::mutex> guard(mtx);
+  refresh();
+  std::vector<std::string> list;
+  for (std::map<std::string, entry>::const_iterator it = index.begin(); it != index.end(); ++it)
+    list.push_back(it->first);
+  return list;
+}
+
+void Pack::enableWrite(fs::path dir) {
+  writeDir = folderKey(dir);
+}
+
+std::shared_ptr<Pack> Pack::reader(const fs::path& file) {
+  // reading never creates a pack, the folders of the inputs are left as they are
+  return find(file, false);
+}
+
+std::shared_ptr<Pack> Pack::writer(const fs::path& file) {
+  if (writeDir.empty() || folderKey(file.parent_path()) != writeDir)
+    return std::shared_ptr<Pack>();
+  return find(file, true);
+}
+
+
+// private
+bool Pack::lock() {
+  // the lock is held by the process, the threads of this process are serialized by mtx
+  struct flock fl;
+  std::memset(&fl, 0, sizeof(fl));
+  fl.l_type = F_WRLCK;
+  fl.l_whence = SEEK_SET;
+  while (fcntl(indexFd, F_SETLKW, &fl) != 0) {
+    if (errno != EINTR) {
+      std::cerr << "Couldn't lock the pack of " << dir << ": " << std::strerror(errno) << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void Pack::unlock() {
+  struct flock fl;
+  std::memset(&fl, 0, sizeof(fl));
+  fl.l_type = F_UNLCK;
+  fl.l_whence = SEEK_SET;
+  fcntl(indexFd, F_SETLK, &fl);
+}
+
+void Pack::refresh() {
+  // entries appended to the index since it was read last, an incomplete one is left for later
+  uint64_t size = fileSize(indexFd);
+  if (size <= indexRead)
+    return;
+  std::string buf(size - indexRead, '\0');
+  if (!preadAll(indexFd, &buf[0], buf.size(), indexRead))
+    return;
+  std::size_t pos = 0;
+  while (pos + sizeof(entry) <= buf.size()) {
+    entry e;
+    std::memcpy(&e, &buf[pos], sizeof(entry));
+    if (pos + sizeof(entry) + e.nameLen > buf.size())
+      break;
+    std::string name(&buf[pos + sizeof(entry)], e.nameLen);
+    if (e.flags == ERASED)
+      index.erase(name);
+    else
+      index[name] = e;
+    dataEnd = std::max(dataEnd, e.offset + e.size);
+    pos += sizeof(entry) + e.nameLen;
+  }
+  indexRead += pos;
+}
+
+void Pack::recover() {
+  // records written by a worker which died before adding them to the index, the index is locked
+  // so an incomplete entry at its end is left from such a worker as well
+  if (fileSize(indexFd) > indexRead && ftruncate(indexFd, indexRead) != 0)
+    std::cerr << "Couldn't truncate the pack index of " << dir << ": " << std::strerror(errno) << "\n";
+  uint64_t size = fileSize(dataFd);
+  while (dataEnd < size) {
+    record r;
+    if (dataEnd + sizeof(record) > size || !preadAll(dataFd, (char*) &r, sizeof(record), dataEnd) ||
+        std::string(r.magic, 4) != "LSSR" || dataEnd + sizeof(record) + r.nameLen + r.size > size)
+      break;
+    std::string name(r.nameLen, '\0');
+    if (!preadAll(dataFd, &name[0], r.nameLen, dataEnd + sizeof(record)))
+      break;
+    entry e = { dataEnd + sizeof(record) + r.nameLen, r.rawSize, r.size, r.flags, r.nameLen };
+    std::string buf((const char*) &e, sizeof(entry));
+    buf += name;
+    if (!pwriteAll(indexFd, buf.data(), buf.size(), fileSize(indexFd)))
+      return;
+    refresh();
+  }
+  // the tail of a record which was not written completely is dropped
+  if (dataEnd < size && ftruncate(dataFd, dataEnd) != 0)
+    std::cerr << "Couldn't truncate the pack of " << dir << ": " << std::strerror(errno) << "\n";
+}
+
+bool Pack::append(const std::string& name, uint32_t flags, uint64_t rawSize, const std::string& payload) {
+  // the record is complete in the data file before its entry makes it visible in the index
+  std::lock_guard<std::mutex> guard(mtx);
+  if (!lock())
+    return false;
+  refresh();
+  recover();
+  record r = { { 'L', 'S', 'S', 'R' }, flags, (uint32_t) name.size(), 0, rawSize, payload.size() };
+  std::string buf((const char*) &r, sizeof(record));
+  buf += name;
+  buf += payload;
+  entry e = { dataEnd + sizeof(record) + name.size(), rawSize, payload.size(), flags, (uint32_t) name.size() };
+  std::string ibuf((const char*) &e, sizeof(entry));
+  ibuf += name;
+  bool ok = pwriteAll(dataFd, buf.data(), buf.size(), dataEnd) &&
+      pwriteAll(indexFd, ibuf.data(), ibuf.size(), fileSize(indexFd));
+  if (ok)
+    refresh();
+  unlock();
+  if (!ok)
+    std::cerr << "Couldn't write " << name << " to the pack of " << dir << ": " << std::strerror(errno) << "\n";
+  return ok;
+}
@@ -0,0 +1,74 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef PACK_H_
+#define PACK_H_
+
+#include "include.h"
+
+#include <map>
+#include <mutex>
+
+// Append-only container of the outputs of one folder, replacing one small file per shape and stage.
+// pack.lssp holds the records (name and deflated payload) one after another, pack.lssi the offset
+// of every record, so a lookup by file name is a search in memory instead of a metadata operation
+// on the file system. A rewritten file is appended again and the latest record wins, an erased one
+// is a record without payload. Writers of several threads or forked workers are serialized by a
+// lock on the index; records missing from the index after a crash are recovered from the data file.
+class Pack {
+public:
+  Pack();
+  virtual ~Pack();
+  bool open(fs::path dir, bool create);
+  bool has(const std::string& name, std::size_t minSize = 0);
+  bool get(const std::string& name, std::string& bytes);
+  bool put(const std::string& name, const std::string& bytes);
+  bool erase(const std::string& name);
+  std::vector<std::string> names();
+
+  // the files written to dir go into its pack from now on
+  static void enableWrite(fs::path dir);
+  // pack of the folder of file, null if the folder has none
+  static std::shared_ptr<Pack> reader(const fs::path& file);
+  // pack the file is written into, null if its folder is not packed
+  static std::shared_ptr<Pack> writer(const fs::path& file);
+
+private:
+  enum { STORED = 0, DEFLATED = 1, ERASED = 2 };
+  struct record {
+    char magic[4];  // LSSR
+    uint32_t flags;
+    uint32_t nameLen;
+    uint32_t reserved;
+    uint64_t rawSize, size;
+  };
+  struct entry {
+    uint64_t offset;  // of the payload in the data file
+    uint64_t rawSize, size;
+    uint32_t flags;
+    uint32_t nameLen;
+  };
+
+  bool lock();
+  void unlock();
+  void refresh();
+  void recover();
+  bool append(const std::string& name, uint32_t flags, uint64_t rawSize, const std::string& payload);
+
+  int dataFd, indexFd;
+  fs::path dir;
+  uint64_t indexRead; // bytes of the index already read
+  uint64_t dataEnd; // end of the last record in the index
+  std::map<std::string, entry> index;
+  std::mutex mtx;
+
+  static std::string writeDir;  // packed output folder, empty for none
+};
+
+#endif /* PACK_H_ */
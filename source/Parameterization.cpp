@@ -8,15 +8,19 @@
  ***************************************************************************************/
 
 #include "Parameterization.h"
+#include "Multilevel.h"
+#include "MeshStream.h"
+#include "Pack.h"
+#include "Simd.h"
 
-Parameterization::Parameterization(std::stringstream & LogFile, fs::path inputPath, fs::path outputPath, bool &useNormal, int &im):
-LogFile(LogFile), useNormal(useNormal), im_size(im)  {
+Parameterization::Parameterization(std::stringstream & LogFile, Workspace & WS, fs::path inputPath, fs::path outputPath, flag &Flag):
+LogFile(LogFile), WS(WS), Flag(Flag), useNormal(Flag.useNormal), im_size(Flag.im_size), gi_rows(0), gi_cols(0), resampling(false), giScale(0)  {
   this->inputPath = inputPath;
   this->paramFile = (outputPath / inputPath.stem()).string() + "_arcSMI.off";
 
   // GI
-  this->paramFile_flatGI = (paramFile.parent_path() / paramFile.stem()).string() + "_" + std::to_string(im_size) + "_flatGI.png";
-  this->paramFile_nflatGI = (paramFile.parent_path() / paramFile.stem()).string() + "_" + std::to_string(im_size) + "_nflatGI.png";
+  this->paramFile_flatGI = GIFile(GIPosition::name());
+  this->paramFile_nflatGI = GIFile(GINormal::name());
 
   // GI2mesh
   this->paramFile_flatGI_off = (outputPath / inputPath.stem()).string() + ".off";
@@ -32,19 +36,29 @@ bool Parameterization::surfaceParameteriseIterative(int iterations) {
     return true;
 
   // read input
-  Surface_mesh sm;
-  if(!meshLoader(inputPath, sm, " input mesh for parameterization", LogFile))
+  Surface_mesh& sm = WS.acquireMesh(Workspace::MESH_3D);
+  if(!WS.loadInput(inputPath, sm, " input mesh for parameterization", LogFile))
     return false;
 
   Border_parameterizer border_param;
   halfedge_descriptor bhd = CGAL::Polygon_mesh_processing::longest_border(sm).first;
   // The 2D points of the uv parametrisation will be written into this map
-  UV_uhm uv_uhm;
-  UV_pmap uv_map(uv_uhm);
+  SM_uvmap uv_map = sm.add_property_map<vertex_descriptor, Point_2>("v:uv").first;
   SMP::Error_code err;
-  double error;
+  double error = 0;
   try {
-    err = SMP::parameterize(sm, Parameterizer(border_param), bhd, uv_map, iterations, error);
+    // fast: one linear solve of the discrete conformal map on the same border
+    if (Flag.param == "fast") {
+      err = SMP::parameterize(sm, Fast_parameterizer(border_param), bhd, uv_map);
+      iterations = 0;
+    }
+    // multilevel: iterative authalic on a simplification, warm started solves up to the slice
+    else if (Flag.param == "multilevel") {
+      Multilevel ML(LogFile, Flag.mlMinVertices, Flag.mlIter);
+      err = ML.parameterize(sm, bhd, uv_map, iterations, error);
+    }
+    else
+      err = SMP::parameterize(sm, Parameterizer(border_param), bhd, uv_map, iterations, error);
   } catch (...) {
     std::cerr << "  SMP::parameterize didn't succeed\n";
     LogFile << "SMP::parameterize didn't succeed\n";
@@ -56,17 +70,20 @@ bool Parameterization::surfaceParameteriseIterative(int iterations) {
     return false;
   }
 
-  std::cout.width(4);
-  std::cout << " " << iterations << std::flush;
-  std::cout.width(10);
-  std::cout << " " << error << std::flush;
+  Progress().width(4);
+  Progress() << " " << iterations;
+  Progress().width(10);
+  Progress() << " " << error;
   LogFile << iterations << "," << error << std::endl;
+  double areaDist, angleDist;
+  distortion(sm, uv_map, areaDist, angleDist);
+  Progress() << ", " << Flag.param << " area " << areaDist;
+  LogFile << "distortion," << Flag.param << "," << areaDist << "," << angleDist << std::endl;
 
-  std::ofstream out(paramFile.string().c_str());
+  // assembled in memory, it is written to the file or the pack once it is complete
+  std::ostringstream out;
   std::size_t vertices_counter = 0, faces_counter = 0;
-  typedef boost::unordered_map<vertex_descriptor, std::size_t> Vertex_index_map;
-  Vertex_index_map vium;
-  boost::associative_property_map<Vertex_index_map> vimap(vium);
+  SM_vimap vimap = sm.add_property_map<vertex_descriptor, int>("v:index").first;
   if (out) {
     out << "OFF\n";
     out << sm.number_of_vertices() << " " << sm.number_of_faces() << " 0\n";
@@ -96,49 +113,136 @@ bool Parameterization::surfaceParameteriseIterative(int iterations) {
       LogFile << "number of faces in 3D 2D are not matching\n";
       return false;
     }
-    std::cout << ", surfParamed" << std::flush;
+    if (!writeFile(paramFile, out.str(), LogFile))
+      return false;
+    Progress() << ", surfParamed";
     return true;
   }
-  else {
-    std::cerr << "Could not open " << paramFile << " to write\n";
-    LogFile << "Could not open " << paramFile << " to write\n";
-    return false;
-  }
   return true;
 }
 
 bool Parameterization::mesh2GI() {
-  // check if the GI already exists
-  if (outfileExists(paramFile_flatGI, 10, ", GIed")) {
-    if (useNormal)  {
-      if(outfileExists(paramFile_nflatGI, 10, ", normalGIed"))
-        return true;
+  // check if all the requested GIs already exist
+  bool GIed = outfileExists(paramFile_flatGI, 10, ", GIed");
+  if (GIed && useNormal)
+    GIed = outfileExists(paramFile_nflatGI, 10, ", normalGIed");
+  if (GIed && Flag.curvGI)
+    GIed = outfileExists(GIFile(GICurvature::name()), 10, ", curvGIed");
+  if (GIed && Flag.colorGI)
+    GIed = outfileExists(GIFile(GIColor::name()), 10, ", colorGIed");
+  if (GIed && Flag.labelGI)
+    GIed = outfileExists(GIFile(GILabel::name()), 10, ", labelGIed");
+  if (GIed && Flag.maskGI)
+    GIed = outfileExists(maskFile("covflatGI"), 10, ", maskGIed");
+  if (GIed && Flag.maskNormal)
+    GIed = outfileExists(maskFile("mflatGI"), 10, ", normalMaskGIed");
+  if (GIed && Flag.vertexTable)
+    GIed = outfileExists(vertexTableFile(), 10, ", vpxED");
+  // the value ranges of the GIs are only known from the sampling, GIs without them are sampled again
+  if (GIed && !Flag.giStats.empty())
+    GIed = readRanges();
+  if (GIed) {
+    // the statistics cover the whole list, GIs of an earlier run are read back
+    addStats(GIPosition::name(), paramFile_flatGI);
+    if (useNormal)
+      addStats(GINormal::name(), paramFile_nflatGI);
+    if (Flag.curvGI)
+      addStats(GICurvature::name(), GIFile(GICurvature::name()));
+    if (Flag.colorGI)
+      addStats(GIColor::name(), GIFile(GIColor::name()));
+    if (Flag.labelGI)
+      addStats(GILabel::name(), GIFile(GILabel::name()));
+    return true;
+  }
+
+  // sample the GIs into the workspace buffers, from the meshes in memory or streamed
+  if (Flag.stream ? !streamNSample() : !loadNSample())
+    return false;
+  cv::Mat& Mnb = WS.Mnb;  // Geometry Image # pts calculator
+
+  // create masks from Mnb, both in one pass of the dispatched kernel
+  cv::Mat& mask_NaN = WS.maskNaN;
+  cv::Mat& mask_value = WS.maskValue;
+  mask_value.create(Mnb.size(), CV_8UC1);
+  mask_NaN.create(Mnb.size(), CV_8UC1);
+  Simd::coverageMasks(Mnb.ptr<float>(), mask_value.ptr<uchar>(), mask_NaN.ptr<uchar>(), Mnb.total());
+  if (Flag.maskGI)
+    maskNSave(mask_value, maskFile("covflatGI"), ", savedMask");
+
+  // Specify convolution filter size required to compensate for no values in geometry image
+  int filterX = 3;
+  int filterY = 3;
+  int nIter = Flag.fillIter;
+  cv::Mat kernel = cv::Mat::ones(filterX, filterY, CV_32F) / (float) (filterX * filterY);
+
+  for (std::size_t l = 0; l < WS.layout.size(); ++l) {
+    const GIChannels& L = WS.layout[l];
+    cv::Mat* outputMap = &WS.GI[L.offset];
+    for (int dim = 0; dim < L.channels; ++dim) {  //each channel of the attribute
+      if (outputMap[dim].cols == 0) {
+        LogFile << "outputMap is empty" << std::endl;
+        std::cerr << "  OutputMap is empty" << std::endl;
+        return false;
+      }
+
+      // divide by the number of vertices, labels hold the one sample of the first face
+      if (L.encoding != GI_LABEL)
+        Simd::divideCounts(outputMap[dim].ptr<float>(), Mnb.ptr<float>(), Mnb.total());
+      // filter the NaNs, labels are not interpolated into the holes
+      if (L.encoding == GI_LABEL)
+        outputMap[dim].setTo(cv::Scalar(0), mask_NaN);
+      else
+        filterOutputMap(outputMap[dim], mask_value, mask_NaN, kernel, nIter);
+    } //each channel
+
+    if (L.name == GIPosition::name())
+      combineNSave(outputMap, L, paramFile_flatGI, ", savedGI");
+    else if (L.name == GINormal::name()) {
+      combineNSave(outputMap, L, paramFile_nflatGI, ", savednGI");
+      if (Flag.maskNormal)
+        normalMaskNSave(paramFile_nflatGI, maskFile("mflatGI"), ", savednMask");
     }
     else
-      return true;
+      encodeNSave(outputMap, L, GIFile(L.name), ", saved" + L.name);
   }
 
-  Surface_mesh Mesh_3D;
-  Surface_mesh Mesh_2D;
+  if (!Flag.giStats.empty() && !writeRanges())
+    return false;
+  if (Flag.vertexTable && !writeVertexTable())
+    return false;
+  return true;
+}
+
+bool Parameterization::loadNSample() {
+  Surface_mesh& Mesh_3D = WS.acquireMesh(Workspace::MESH_3D);
+  Surface_mesh& Mesh_2D = WS.acquireMesh(Workspace::MESH_2D);
 
   // Start with Loading of Mesh_3D
-  if (!meshLoader(inputPath, Mesh_3D, "3D mesh", LogFile, false))
+  if (!WS.loadInput(inputPath, Mesh_3D, "3D mesh", LogFile, false))
     return false;
 
-  // create the normal property map if normal GI needs to be computed
-  Surface_mesh::Property_map<vertex_descriptor, Kernel::Vector_3> Mesh_3D_nm;
-  if (useNormal) {
-    Mesh_3D_nm = Mesh_3D.add_property_map<vertex_descriptor,Kernel::Vector_3>("v:normals", CGAL::NULL_VECTOR).first;
-    PMP::compute_vertex_normals(Mesh_3D, Mesh_3D_nm);
-  }
+  // a sampling map of this parameterization and size replaces the flat mesh
+  resampling = Flag.sampleMap && readSampleMap(Mesh_3D.number_of_vertices());
+  // the vertex table needs the uv of every vertex, so the flat mesh is loaded even when resampling
+  if ((!resampling || Flag.vertexTable) && !loadFlat(Mesh_3D, Mesh_2D))
+    return false;
+  if (Flag.vertexTable)
+    vertexPixels(Mesh_2D);
 
+  // sample the position and every requested attribute at the pixels covered by the parameterization
+  GIDispatch dispatch = { this, &Mesh_3D, &Mesh_2D };
+  bool on[] = { useNormal, Flag.curvGI, Flag.colorGI, Flag.labelGI };
+  return GISelect<GIList<GIPosition>, GINormal, GICurvature, GIColor, GILabel>::run(on, dispatch);
+}
+
+bool Parameterization::loadFlat(Surface_mesh& Mesh_3D, Surface_mesh& Mesh_2D) {
   if (!meshLoader(paramFile, Mesh_2D, "flat mesh", LogFile, false))
     return false;
 
   // check if Mesh_2D has any vertex which is an outlier
   BOOST_FOREACH(vertex_descriptor vd, vertices(Mesh_2D))  {
     Point_3 pt = Mesh_2D.point(vd);
-    if(abs(pt.x()) > 1.5 || abs(pt.y()) > 1.5)  {
+    if(std::abs(pt.x()) > 1.5 || std::abs(pt.y()) > 1.5)  {
       std::cerr << " " << vd << "(" << pt.x() << "," << pt.y() << ")" << std::endl;
       LogFile << " " << vd << "(" << pt.x() << "," << pt.y() << ")" << std::endl;
       return false;
@@ -153,7 +257,8 @@ bool Parameterization::mesh2GI() {
     return false;
   }
 
-  std::vector<vertex_descriptor> Mesh_3D_vds(Mesh_3D.num_vertices());
+  std::vector<vertex_descriptor>& Mesh_3D_vds = WS.vds;
+  Mesh_3D_vds.reserve(Mesh_3D.num_vertices());
   vertex_iterator tmvi = CGAL::vertices(Mesh_3D).begin(), tmvi_end = CGAL::vertices(Mesh_3D).end();
   CGAL_For_all(tmvi, tmvi_end)
   Mesh_3D_vds.push_back(*tmvi);
@@ -162,217 +267,211 @@ bool Parameterization::mesh2GI() {
   int i = 0;
   BOOST_FOREACH(vertex_descriptor vd, vertices(Mesh_2D))
   put(Mesh_2D_vimap, vd, i++);
+  return true;
+}
 
-  // matrices for GI
-  cv::Mat M0 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  cv::Mat M1 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  cv::Mat M2 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  std::map<int, cv::Mat> outputMap;
-  outputMap[0] = M0;
-  outputMap[1] = M1;
-  outputMap[2] = M2;
-
-  // matrices for normal GI
-  cv::Mat nM0 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  cv::Mat nM1 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  cv::Mat nM2 = cv::Mat::zeros(im_size, im_size, CV_32FC1);  // Geometry Image
-  std::map<int, cv::Mat> noutputMap;
-  noutputMap[0] = nM0;
-  noutputMap[1] = nM1;
-  noutputMap[2] = nM2;
-
-  if (!useNormal) {
-    nM0.release();
-    nM1.release();
-    nM2.release();
-  }
-
-  cv::Mat P = cv::Mat::zeros(2, 3, CV_32F); // Current 2D point
-  cv::Mat V = cv::Mat::zeros(3, 3, CV_32F); // current dimension value of 3D Mesh
-  cv::Mat nV = cv::Mat::zeros(3, 3, CV_32F);  // current dimension value of 3D Mesh Normals
-
-  int f_idx = 0;
-  cv::Mat Mnb = cv::Mat::zeros(im_size, im_size, CV_32FC1); // Geometry Image # pts calculator
-  BOOST_FOREACH(face_descriptor fd, Mesh_2D.faces()) {
-    int vt_count = 0;
-    BOOST_FOREACH(vertex_descriptor vd_2D, vertices_around_face(Mesh_2D.halfedge(fd), Mesh_2D)) {
-      P.at<float>(0, vt_count) = Mesh_2D.point(vd_2D)[0] * (im_size - 1);
-      P.at<float>(1, vt_count) = Mesh_2D.point(vd_2D)[1] * (im_size - 1);
-      // find the 3D mesh vertex index corresponding to the 2d mesh vd
-      vertex_descriptor vd_3D;
-      vd_3D = vd_2D;
-
-      for (int dim = 0; dim < 3; ++dim) {
-        //each Dimension of 3D mesh
-        V.at<float>(dim, vt_count) = Mesh_3D.point(vd_3D)[dim];
-        if (useNormal)
-          nV.at<float>(dim, vt_count) = Mesh_3D_nm[vd_3D][dim];
-      }
-      vt_count++;
-    }
+bool Parameterization::readSampleMap(std::size_t nVertices) {
+  // the map is only valid for the current parameterization at the current size
+  // a parameterization in a pack has no time stamp to compare with, its map is not used
+  fs::path mapFile = sampleMapFile();
+  boost::system::error_code ec;
+  std::time_t paramTime = fs::last_write_time(paramFile, ec);
+  if (ec || !fs::exists(mapFile) || fs::last_write_time(mapFile) < paramTime)
+    return false;
+  if (!WS.smap.read(mapFile) || WS.smap.size() != im_size || WS.smap.nVertices() != nVertices) {
+    LogFile << "sampling map " << mapFile.filename().string() << " not used\n";
+    return false;
+  }
+  return true;
+}
 
-    // V and P values corresponding to the current face is obtained
-    // Now we work on these values
-    cv::Mat pos, z1, z2;
-    // Dimensions of the mesh grid
-    int n_rows = Ceil(P.row(0)) - Floor(P.row(0)) + 1;
-    int n_cols = Ceil(P.row(1)) - Floor(P.row(1)) + 1;
-    if(n_rows<= 0 ||n_cols<= 0)
-      continue;
-    try {
-      z1.create(n_rows, n_cols, CV_32FC1);
-      z2.create(n_rows, n_cols, CV_32FC1);
-    }
-    catch(...)  {
-      std::cerr << "Couldn't create z1 or z2\n";
-      LogFile << "Couldn't create z1 or z2\n";
-      return false;
-    }
-    for (int i = 0; i < z1.rows; ++i) {
-      for (int j = 0; j < z1.cols; ++j) {
-        z1.at<float>(i, j) = Floor(P.row(0)) + i;
-        z2.at<float>(i, j) = Floor(P.row(1)) + j;
-      }
-    }
+fs::path Parameterization::sampleMapFile() {
+  fs::path mapFile = GIFile("smap");
+  return mapFile.replace_extension(".bin");
+}
 
-    z1 = z1.t();
-    z1 = z1.reshape(0, 1);
-    z2 = z2.t();
-    z2 = z2.reshape(0, 1);
-    cv::vconcat(z1, z2, pos);
-
-    // barycentric coords computation
-    cv::Mat tmp1, tmp2, c;
-    cv::vconcat(cv::Mat::ones(1, P.cols, CV_32F), P, tmp1);
-    cv::vconcat(cv::Mat::ones(1, pos.cols, CV_32F), pos, tmp2);
-    cv::solve(tmp1, tmp2, c);
-
-    // restrict the BC to inside triangle
-    cv::Mat pos1, c1;
-    c1.convertTo(c1, CV_32F);
-    pos1.convertTo(pos1, CV_32F);
-    for (int i = 0; i < c.cols; i++) {
-      // cutoff was previously taken from octave but should be different for c++ beacuse of difference in datatypes
-      if (c.at<float>(0, i) >= -0.000022204
-          && c.at<float>(1, i) >= -0.000022204
-          && c.at<float>(2, i) >= -0.000022204
-          && !((c.at<float>(0, i) == 0) && (c.at<float>(1, i) == 0)
-              && (c.at<float>(2, i) == 0))) {
-        cv::Mat trash1 = c.col(i).t();
-        c1.push_back(trash1);
-        cv::Mat trash2 = pos.col(i).t();
-        pos1.push_back(trash2);
-      }
-    }
-    if (c1.empty() || pos1.empty()) {
-      pos1.release();
-      c1.release();
-      f_idx++;
-      continue;
-    }
-    c = c1.t();
-    pos = pos1.t();
-    pos1.release();
-    c1.release();
-
-    // restrict the pos to inside the image
-    // TODO: this condition never seems to happen
-    for (int i = 0; i < pos.cols; i++) {
-      if (pos.at<float>(0, i) >= 0) {
-        if (pos.at<float>(0, i) < im_size) {
-          if (pos.at<float>(1, i) >= 0) {
-            if (pos.at<float>(1, i) < im_size) {
-              cv::Mat trash1 = c.col(i).t();
-              c1.push_back(trash1);
-              cv::Mat trash2 = pos.col(i).t();
-              pos1.push_back(trash2);
-
-            }
-          }
-        }
-      }
-    }
+fs::path Parameterization::vertexTableFile() {
+  fs::path tableFile = GIFile("vpx");
+  return tableFile.replace_extension(".txt");
+}
 
-    if (c1.empty() || pos1.empty()) {
-      pos1.release();
-      c1.release();
-      f_idx++;
-      continue;
-    }
+void Parameterization::vertexPixels(Surface_mesh& Mesh_2D) {
+  // the pixel space position of the vertex, as the samplers place the corners of the faces
+  vertexPx.resize(2 * Mesh_2D.number_of_vertices());
+  std::size_t v = 0;
+  BOOST_FOREACH(vertex_descriptor vd, vertices(Mesh_2D)) {
+    vertexPx[v++] = Mesh_2D.point(vd)[0] * (im_size - 1);
+    vertexPx[v++] = Mesh_2D.point(vd)[1] * (im_size - 1);
+  }
+}
 
-    c = c1.t();
-    pos = pos1.t();
-    pos1.release();
-    c1.release();
-
-    // Now the value assignment has to be done
-    for (int i = 0; i < pos.cols; i++) {
-      int r_idx = (int) pos.at<float>(0, i);
-      int c_idx = (int) pos.at<float>(1, i);
-      for (int dim = 0; dim < 3; ++dim) {  //each Dimension of 3D mesh
-        outputMap[dim].at<float>(r_idx, c_idx) =
-            outputMap[dim].at<float>(r_idx, c_idx)
-            + V.at<float>(dim, 0) * c.at<float>(0, i)
-            + V.at<float>(dim, 1) * c.at<float>(1, i)
-            + V.at<float>(dim, 2) * c.at<float>(2, i);
-        if (useNormal)
-          noutputMap[dim].at<float>(r_idx, c_idx) =
-              noutputMap[dim].at<float>(r_idx, c_idx)
-              + nV.at<float>(dim, 0) * c.at<float>(0, i)
-              + nV.at<float>(dim, 1) * c.at<float>(1, i)
-              + nV.at<float>(dim, 2) * c.at<float>(2, i);
-      }
-      Mnb.at<float>(r_idx, c_idx) = Mnb.at<float>(r_idx, c_idx) + 1;
-    }
-    f_idx++;
-  } // for all faces
+bool Parameterization::writeVertexTable() {
+  // one line per vertex of the slice in its order, after the normalization of the position GI
+  if (giScale <= 0 || vertexPx.empty()) {
+    std::cerr << "  No vertex table without the position GI" << std::endl;
+    LogFile << "No vertex table without the position GI" << std::endl;
+    return false;
+  }
+  std::ostringstream out;
+  out.precision(9);
+  out << "vpx " << vertexPx.size() / 2 << " " << im_size << " " << giMin[0] << " " << giMin[1] << " " << giMin[2] << " " << giScale << "\n";
+  for (std::size_t v = 0; v < vertexPx.size(); v += 2)
+    out << vertexPx[v] << " " << vertexPx[v + 1] << "\n";
+  if (!writeFile(vertexTableFile(), out.str(), LogFile))
+    return false;
+  Progress() << ", savedVpx";
+  return true;
+}
 
-  // create masks from Mnb
-  cv::Mat tmp_mask_value(im_size, im_size, CV_8UC1);
-  cv::Mat tmp_mask_NaN(im_size, im_size, CV_8UC1);
-  cv::threshold(Mnb, tmp_mask_value, 0, 255, cv::THRESH_BINARY);
-  cv::threshold(Mnb, tmp_mask_NaN, 0, 255, cv::THRESH_BINARY_INV);
+bool Parameterization::applyGI() {
+  fs::path appliedFile = GIFile("applied"), errFile = GIFile("verr");
+  appliedFile.replace_extension(".off");
+  errFile.replace_extension(".txt");
+  if (outfileExists(appliedFile, 10, ", appliedED"))
+    return true;
 
-  cv::Mat mask_NaN, mask_value;
-  tmp_mask_NaN.convertTo(mask_NaN, CV_8UC1);
-  tmp_mask_value.convertTo(mask_value, CV_8UC1);
-  tmp_mask_NaN.release();
-  tmp_mask_value.release();
+  // vertex table of the slice
+  std::string bytes;
+  fs::path tableFile = vertexTableFile();
+  if (!infileExists(tableFile, 0, "vertex table ", LogFile) || !readFile(tableFile, bytes))
+    return false;
+  std::istringstream table(bytes);
+  std::string magic;
+  std::size_t nV = 0;
+  int tableSize = 0;
+  double minV[3], scale = 0;
+  table >> magic >> nV >> tableSize >> minV[0] >> minV[1] >> minV[2] >> scale;
+  std::vector<float> px(2 * nV);
+  for (std::size_t k = 0; k < px.size() && table; ++k)
+    table >> px[k];
+  if (!table || magic != "vpx" || tableSize < 2) {
+    std::cerr << "  Couldn't read the vertex table " << tableFile << std::endl;
+    LogFile << "Couldn't read the vertex table " << tableFile.filename().string() << std::endl;
+    return false;
+  }
 
-  // Specify convolution filter size required to compensate for no values in geometry image
-  int filterX = 3;
-  int filterY = 3;
-  int nIter = 20;
-  cv::Mat kernel = cv::Mat::ones(filterX, filterY, CV_32F) / (float) (filterX * filterY);
+  // predicted GI, the values of 8 and 16 bit images are scaled to [0,1]
+  fs::path predFile = fs::path(Flag.applyGI) / fs::path(paramFile_flatGI).filename();
+  if (!infileExists(predFile, 0, "predicted GI ", LogFile))
+    return false;
+  cv::Mat pred = readImage(predFile, cv::IMREAD_UNCHANGED);
+  if (pred.channels() != 3 || pred.rows < 2 || pred.cols < 2) {
+    std::cerr << "  " << predFile << " is not a 3 channel GI" << std::endl;
+    LogFile << predFile.filename().string() << " is not a 3 channel GI" << std::endl;
+    return false;
+  }
+  double range = pred.depth() == CV_8U ? 255.0 : (pred.depth() == CV_16U ? 65535.0 : 1.0);
+  pred.convertTo(pred, CV_32FC3, 1.0 / range);
 
-  for (int dim = 0; dim < 3; ++dim) {  //each Dimension of 3D mesh
-    if (outputMap[dim].cols == 0) {
-      LogFile << "outputMap is empty" << std::endl;
-      std::cerr << "  OutputMap is empty" << std::endl;
-      return false;
+  Surface_mesh& sm = WS.acquireMesh(Workspace::MESH_3D);
+  if (!WS.loadInput(inputPath, sm, " slice for the predicted GI", LogFile))
+    return false;
+  if (sm.number_of_vertices() != nV) {
+    std::cerr << "  The vertex table doesn't match the slice" << std::endl;
+    LogFile << "The vertex table doesn't match the slice" << std::endl;
+    return false;
+  }
+
+  // bilinear lookup at the vertex pixels, a prediction of another size is sampled at the same
+  // relative position; the channels are in the order OpenCV reads a GI file, x first
+  double rScale = (pred.rows - 1) / (double) (tableSize - 1), cScale = (pred.cols - 1) / (double) (tableSize - 1);
+  std::ostringstream err;
+  double sum = 0, sumSq = 0, maxErr = 0;
+  std::size_t v = 0;
+  BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+    double r = std::min(std::max(px[2 * v] * rScale, 0.0), pred.rows - 1.0);
+    double c = std::min(std::max(px[2 * v + 1] * cScale, 0.0), pred.cols - 1.0);
+    int r0 = std::min((int) r, pred.rows - 2), c0 = std::min((int) c, pred.cols - 2);
+    double dr = r - r0, dc = c - c0;
+    const cv::Vec3f& p00 = pred.at<cv::Vec3f>(r0, c0);
+    const cv::Vec3f& p01 = pred.at<cv::Vec3f>(r0, c0 + 1);
+    const cv::Vec3f& p10 = pred.at<cv::Vec3f>(r0 + 1, c0);
+    const cv::Vec3f& p11 = pred.at<cv::Vec3f>(r0 + 1, c0 + 1);
+    double P[3];
+    for (int d = 0; d < 3; ++d) {
+      double val = (1 - dr) * ((1 - dc) * p00[d] + dc * p01[d]) + dr * ((1 - dc) * p10[d] + dc * p11[d]);
+      P[d] = minV[d] + val * scale;
     }
+    Point_3 predicted(P[0], P[1], P[2]);
+    double e = std::sqrt(CGAL::to_double(CGAL::squared_distance(sm.point(vd), predicted)));
+    sm.point(vd) = predicted;
+    err << e << "\n";
+    sum += e;
+    sumSq += e * e;
+    maxErr = std::max(maxErr, e);
+    ++v;
+  }
 
-    // divide by the number of vertices
-    outputMap[dim] /= Mnb;
-    noutputMap[dim] /= Mnb;
-    // filter the NaNs
-    // 1. for GI
-    filterOutputMap(outputMap[dim], mask_value, mask_NaN, kernel, nIter);
-    // 2. if required then for mormal GI
-    if (useNormal)
-      filterOutputMap(noutputMap[dim], mask_value, mask_NaN, kernel, nIter);
-  } //each dimension
+  double mean = nV ? sum / nV : 0, rms = nV ? std::sqrt(sumSq / nV) : 0;
+  LogFile << "applyGI," << nV << "," << mean << "," << rms << "," << maxErr << std::endl;
+  Progress() << ", vertexErr " << mean;
+  if (!writeFile(errFile, err.str(), LogFile))
+    return false;
+  return saveMesh(appliedFile, sm, ", applied", LogFile);
+}
 
-  // 1. for GI
-  combineNSave(outputMap, paramFile_flatGI, ", savedGI");
-  // 2. if required for Normal GI
-  if(useNormal)
-    combineNSave(noutputMap, paramFile_nflatGI, ", savednGI");
+bool Parameterization::streamNSample() {
+  // only the position is stored in the packed mesh, the other attributes need the whole mesh
+  if (useNormal || Flag.curvGI || Flag.colorGI || Flag.labelGI) {
+    std::cerr << "  Only the position GI can be streamed" << std::endl;
+    LogFile << "Only the position GI can be streamed" << std::endl;
+    return false;
+  }
+  std::shared_ptr<Pack> packed = Pack::reader(paramFile);
+  if (packed && packed->has(paramFile.filename().string())) {
+    std::cerr << "  The streamed meshes are read from files, not from a pack" << std::endl;
+    LogFile << "The streamed meshes are read from files, not from a pack" << std::endl;
+    return false;
+  }
+  // the packed mesh is kept next to the parameterized mesh and reused while it is newer
+  fs::path binFile = paramFile;
+  binFile.replace_extension(".bin");
+  if (!fs::exists(binFile) || fs::last_write_time(binFile) < fs::last_write_time(paramFile) ||
+      fs::last_write_time(binFile) < fs::last_write_time(inputPath)) {
+    if (!MeshStream::pack(inputPath, paramFile, binFile, LogFile))
+      return false;
+  }
+  MeshStream stream;
+  if (!stream.open(binFile, LogFile))
+    return false;
+  if (Flag.vertexTable) {
+    vertexPx.resize(2 * stream.nVertices());
+    for (std::size_t v = 0; v < stream.nVertices(); ++v) {
+      vertexPx[2 * v] = stream.vertex(v)[0] * (im_size - 1);
+      vertexPx[2 * v + 1] = stream.vertex(v)[1] * (im_size - 1);
+    }
+    stream.release();
+  }
 
+  GIGenerator<GIPosition> generator;
+  generator.layout(WS.layout);
+  WS.acquireGI(im_size, GIGenerator<GIPosition>::channels);
+  float P[2][3];
+  float V[3][GIGenerator<GIPosition>::channels];
+  for (std::size_t first = 0; first < stream.nFaces(); first += Flag.stream) {
+    std::size_t last = std::min(stream.nFaces(), first + (std::size_t) Flag.stream);
+    for (std::size_t f = first; f < last; ++f) {
+      const int32_t* fv = stream.face(f);
+      for (int k = 0; k < 3; ++k) {
+        const float* rec = stream.vertex(fv[k]);
+        P[0][k] = rec[0] * (im_size - 1);
+        P[1][k] = rec[1] * (im_size - 1);
+        V[k][0] = rec[2];
+        V[k][1] = rec[3];
+        V[k][2] = rec[4];
+      }
+      generator.rasterize(P, V, im_size, &WS.GI[0], WS.Mnb);
+    }
+    stream.release();
+  }
+  Progress() << ", streamed " << stream.nFaces() << " faces";
   return true;
 }
 
 bool Parameterization::GI2off()  {
+  // a batch of GIs saved with numpy is remeshed as a whole
+  if (inputPath.extension().string() == ".npy")
+    return GI2offBatch();
 
   std::string inputPathStr = inputPath.string();
   if(inputPath.extension().string() == ".png") {
@@ -406,6 +505,10 @@ bool Parameterization::GI2off()  {
   if(!addVerticestoSM(sm))
     return false;
 
+  // triangulated grid with coincident vertices merged
+  if (Flag.weld > 0 || Flag.mirror)
+    return weldNSave(sm, paramFile_flatGI_off);
+
   if(!saveMesh(paramFile_flatGI_off, sm, ", off", LogFile))
     return false;
 
@@ -413,17 +516,351 @@ bool Parameterization::GI2off()  {
 }
 
 
+bool Parameterization::GI2off(const cv::Mat& GI) {
+  // GI held in memory, e.g. predicted by the network: CV_32FC3 with values in [0,1] and the
+  // channels in the order OpenCV reads a GI file, x first
+  if (GI.empty() || GI.type() != CV_32FC3) {
+    LogFile << "GI to remesh is not a 3 channel float image\n";
+    return false;
+  }
+  gi_rows = GI.rows;
+  gi_cols = GI.cols;
+
+  Surface_mesh& sm = WS.acquireMesh(Workspace::MESH_3D);
+  sm.reserve(gi_rows * gi_cols, 0, 0);
+  for (int i = 0; i < gi_rows; i++) {
+    const cv::Vec3f* row = GI.ptr<cv::Vec3f>(i);
+    for (int j = 0; j < gi_cols; j++)
+      sm.add_vertex(Point_3(row[j][0], row[j][1], row[j][2]));
+  }
+
+  if (Flag.weld > 0 || Flag.mirror)
+    return weldNSave(sm, paramFile_flatGI_off);
+  return saveMesh(paramFile_flatGI_off, sm, ", off", LogFile);
+}
+
+
 //private
+bool Parameterization::GI2offBatch() {
+  std::vector<cv::Mat> GIs;
+  if (!readNpy(inputPath, GIs))
+    return false;
+
+  // GI k of the batch is written as <batch>_<k>.off to the output folder; the items are taken
+  // in turn by the threads, each with its own workspace
+  fs::path outputPath = paramFile_flatGI_off.parent_path();
+  std::string stem = inputPath.stem().string();
+  std::atomic<int> next(0), nWritten(0);
+  std::vector<std::stringstream> logs(GIs.size());
+  int nThreads = std::min((int) GIs.size(), (int) std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t)
+    threads.push_back(std::thread([&] {
+      Workspace itemWS;
+      for (int k = next++; k < (int) GIs.size(); k = next++) {
+        fs::path itemPath = inputPath.parent_path() / (stem + "_" + std::to_string(k) + ".npy");
+        Parameterization PM(logs[k], itemWS, itemPath, outputPath, Flag);
+        itemWS.beginItem();
+        if (outfileExists(PM.paramFile_flatGI_off, 10, "") || PM.GI2off(GIs[k]))
+          ++nWritten;
+        else
+          logs[k] << "item " << k << " not remeshed\n";
+      }
+    }));
+  for (int t = 0; t < nThreads; ++t)
+    threads[t].join();
+  for (std::size_t k = 0; k < logs.size(); ++k)
+    LogFile << logs[k].str();
+
+  Progress() << ", " << nWritten << "/" << GIs.size() << " offs";
+  return nWritten == (int) GIs.size();
+}
+
+bool Parameterization::readNpy(fs::path npyFile, std::vector<cv::Mat>& GIs) {
+  // .npy of shape (N, H, W, 3) or (H, W, 3), C order, float32, float64 or 8/16 bit unsigned; the
+  // channels are in the RGB order of the network prediction, integers are scaled to [0,1]
+  std::ifstream in(npyFile.string().c_str(), std::ios::binary);
+  char magic[8];
+  if (!in.read(magic, 8) || std::string(magic, 6) != "\x93NUMPY") {
+    std::cerr << "  " << npyFile << " is not a .npy file\n";
+    LogFile << npyFile.filename().string() << " is not a .npy file\n";
+    return false;
+  }
+  uint32_t headerLen = 0;
+  unsigned char len[4] = { 0, 0, 0, 0 };
+  in.read((char*) len, magic[6] == 1 ? 2 : 4);
+  headerLen = len[0] | len[1] << 8 | len[2] << 16 | (uint32_t) len[3] << 24;
+  std::string header(headerLen, ' ');
+  in.read(&header[0], headerLen);
+
+  std::size_t d = header.find("'descr'"), f = header.find("'fortran_order'"), s = header.find("'shape'");
+  if (!in || d == std::string::npos || f == std::string::npos || s == std::string::npos) {
+    std::cerr << "  Couldn't read the header of " << npyFile << "\n";
+    LogFile << "Couldn't read the header of " << npyFile.filename().string() << "\n";
+    return false;
+  }
+  std::size_t q0 = header.find('\'', d + 7) + 1;
+  std::string descr = header.substr(q0, header.find('\'', q0) - q0);
+  bool fortran = header.substr(header.find(':', f) + 1, 6).find("True") != std::string::npos;
+  std::string shapeStr = header.substr(header.find('(', s) + 1, header.find(')', s) - header.find('(', s) - 1);
+  std::vector<int> shape;
+  std::vector<std::string> dims = splitString(shapeStr, ", ");
+  for (std::size_t k = 0; k < dims.size(); ++k)
+    shape.push_back(atoi(dims[k].c_str()));
+
+  int depth = -1;
+  double scale = 1;
+  if (descr == "<f4" || descr == "=f4")
+    depth = CV_32F;
+  else if (descr == "<f8" || descr == "=f8")
+    depth = CV_64F;
+  else if (descr == "|u1" || descr == "<u1")
+    depth = CV_8U, scale = 1.0 / 255;
+  else if (descr == "<u2" || descr == "=u2")
+    depth = CV_16U, scale = 1.0 / 65535;
+  if (shape.size() == 3)
+    shape.insert(shape.begin(), 1);
+  if (depth < 0 || fortran || shape.size() != 4 || shape[3] != 3) {
+    std::cerr << "  " << npyFile << " is not a batch of 3 channel GIs (" << descr << ", (" << shapeStr << "))\n";
+    LogFile << npyFile.filename().string() << " is not a batch of 3 channel GIs (" << descr << ", (" << shapeStr << "))\n";
+    return false;
+  }
+
+  cv::Mat raw(shape[1], shape[2], CV_MAKETYPE(depth, 3));
+  GIs.resize(shape[0]);
+  for (int k = 0; k < shape[0]; ++k) {
+    if (!in.read((char*) raw.data, raw.total() * raw.elemSize())) {
+      std::cerr << "  " << npyFile << " holds fewer GIs than its shape\n";
+      LogFile << npyFile.filename().string() << " holds fewer GIs than its shape\n";
+      return false;
+    }
+    raw.convertTo(GIs[k], CV_32FC3, scale);
+    cv::cvtColor(GIs[k], GIs[k], cv::COLOR_RGB2BGR);
+  }
+  return true;
+}
+
+void Parameterization::distortion(Surface_mesh& sm, SM_uvmap& uv_map, double& areaDist, double& angleDist) {
+  // area: area weighted mean of |log| of the ratio of the relative face areas in uv and 3D, 0 when authalic
+  // angle: mean absolute difference of the corner angles in uv and 3D in degrees, 0 when conformal
+  std::vector<double> A3, A2;
+  double sum3 = 0, sum2 = 0, angleSum = 0;
+  int nCorners = 0;
+  BOOST_FOREACH(face_descriptor fd, faces(sm)) {
+    Point_3 p[3];
+    Point_2 q[3];
+    int k = 0;
+    BOOST_FOREACH(vertex_descriptor vd, vertices_around_face(halfedge(fd, sm), sm)) {
+      if (k < 3) {
+        p[k] = sm.point(vd);
+        q[k] = get(uv_map, vd);
+      }
+      ++k;
+    }
+    if (k != 3)
+      continue;
+    A3.push_back(std::sqrt(CGAL::to_double(CGAL::squared_area(p[0], p[1], p[2]))));
+    A2.push_back(std::abs(CGAL::to_double(CGAL::area(q[0], q[1], q[2]))));
+    sum3 += A3.back();
+    sum2 += A2.back();
+    for (int c = 0; c < 3; ++c) {
+      Kernel::Vector_3 u3 = p[(c + 1) % 3] - p[c], v3 = p[(c + 2) % 3] - p[c];
+      Kernel::Vector_2 u2 = q[(c + 1) % 3] - q[c], v2 = q[(c + 2) % 3] - q[c];
+      double l3 = std::sqrt(CGAL::to_double(u3.squared_length() * v3.squared_length()));
+      double l2 = std::sqrt(CGAL::to_double(u2.squared_length() * v2.squared_length()));
+      if (l3 <= 0 || l2 <= 0)
+        continue;
+      double a3 = std::acos(std::max(-1.0, std::min(1.0, CGAL::to_double(u3 * v3) / l3)));
+      double a2 = std::acos(std::max(-1.0, std::min(1.0, CGAL::to_double(u2 * v2) / l2)));
+      angleSum += std::abs(a3 - a2);
+      ++nCorners;
+    }
+  }
+  areaDist = 0;
+  for (std::size_t f = 0; f < A3.size() && sum3 > 0 && sum2 > 0; ++f) {
+    if (A3[f] > 0 && A2[f] > 0)
+      areaDist += A3[f] / sum3 * std::abs(std::log((A2[f] / sum2) / (A3[f] / sum3)));
+  }
+  angleDist = nCorners ? angleSum / nCorners * 180 / CGAL_PI : 0;
+}
+
+bool Parameterization::weldNSave(Surface_mesh& sm, fs::path meshFile) {
+  // vertices of sm are the pixels of the GI in row major order
+  int nGrid = gi_rows * gi_cols;
+  if (nGrid == 0 || (int) sm.number_of_vertices() != nGrid) {
+    LogFile << "GI has " << sm.number_of_vertices() << " vertices for a " << gi_rows << "x" << gi_cols << " grid\n";
+    return false;
+  }
+  // by default only positions equal after 8 bit quantization are merged
+  Welder W(Flag.weld > 0 ? Flag.weld : 0.5 / 255);
+  int nCopies = Flag.mirror ? 2 : 1;
+  std::vector<int> remap(nCopies * nGrid);
+  for (int k = 0; k < nGrid; ++k)
+    remap[k] = W.insert(sm.point(vertex_descriptor(k)));
+  if (Flag.mirror) {
+    // the slice plane is x = 0 in the frame of the GI, vertices on it weld with their mirror image
+    for (int k = 0; k < nGrid; ++k) {
+      const Point_3& p = sm.point(vertex_descriptor(k));
+      remap[nGrid + k] = W.insert(Point_3(-p.x(), p.y(), p.z()));
+    }
+  }
+  const std::vector<Point_3>& pts = W.points();
+
+  // two triangles per grid cell, the mirrored copy with reversed orientation;
+  // triangles which collapse or repeat after welding are dropped
+  std::vector<int> tris;
+  std::unordered_set<long long> seen;
+  for (int copy = 0; copy < nCopies; ++copy) {
+    const int* m = &remap[copy * nGrid];
+    for (int i = 0; i < gi_rows - 1; ++i) {
+      for (int j = 0; j < gi_cols - 1; ++j) {
+        int a = m[i * gi_cols + j], b = m[i * gi_cols + j + 1];
+        int c = m[(i + 1) * gi_cols + j], d = m[(i + 1) * gi_cols + j + 1];
+        int cell[2][3] = { { a, c, b }, { b, c, d } };
+        for (int t = 0; t < 2; ++t) {
+          int* v = cell[t];
+          if (copy == 1)
+            std::swap(v[1], v[2]);
+          if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2])
+            continue;
+          if (CGAL::collinear(pts[v[0]], pts[v[1]], pts[v[2]]))
+            continue;
+          int s[3] = { v[0], v[1], v[2] };
+          std::sort(s, s + 3);
+          if (!seen.insert(((long long) s[0] << 42) | ((long long) s[1] << 21) | s[2]).second)
+            continue;
+          tris.insert(tris.end(), v, v + 3);
+        }
+      }
+    }
+  }
+
+  // written as a polygon soup, the welded grid can be non-manifold where pixels collapsed
+  std::ostringstream out_fs;
+  out_fs << "OFF\n" << pts.size() << " " << tris.size() / 3 << " 0\n";
+  for (std::size_t k = 0; k < pts.size(); ++k)
+    out_fs << pts[k].x() << " " << pts[k].y() << " " << pts[k].z() << "\n";
+  for (std::size_t t = 0; t < tris.size(); t += 3)
+    out_fs << "3 " << tris[t] << " " << tris[t + 1] << " " << tris[t + 2] << "\n";
+  if (!writeFile(meshFile, out_fs.str(), LogFile))
+    return false;
+
+  LogFile << "weld," << nCopies * nGrid << "," << pts.size() << "," << tris.size() / 3 << std::endl;
+  Progress() << ", welded " << pts.size() << "/" << nCopies * nGrid;
+  return true;
+}
+
+template <typename... Attrs>
+bool Parameterization::sampleGI(Surface_mesh& Mesh_3D, Surface_mesh& Mesh_2D) {
+  // one generator per combination of attributes, all of them are sampled in the same pass
+  GIGenerator<Attrs...> generator;
+  if (!generator.prepare(Mesh_3D, inputPath, LogFile))
+    return false;
+  generator.layout(WS.layout);
+  WS.acquireGI(im_size, GIGenerator<Attrs...>::channels);
+
+  if (resampling) {
+    WS.smap.resample(generator, &WS.GI[0], WS.Mnb);
+    Progress() << ", resampled";
+    return true;
+  }
+  if (Flag.gather) {
+    gatherGI(generator, Mesh_2D);
+    if (Flag.gatherCheck)
+      compareSamplers(generator, Mesh_2D);
+  }
+  else
+    generator.scatter(Mesh_2D, im_size, &WS.GI[0], WS.Mnb);
+
+  // the map holds the scatter samples, later runs on this parameterization resample from it
+  if (Flag.sampleMap) {
+    WS.smap.build(Mesh_2D, im_size);
+    if (!WS.smap.write(sampleMapFile()))
+      LogFile << "Couldn't write sampling map\n";
+  }
+  return true;
+}
+
+template <typename Generator>
+void Parameterization::gatherGI(const Generator& generator, Surface_mesh& Mesh_2D) {
+  // every pixel looks up the one face containing it, so each pixel holds exactly one sample
+  WS.grid.build(Mesh_2D, im_size);
+
+  // pixels are written by exactly one thread, so the rows are interleaved over the threads without locking
+  int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t)
+    threads.push_back(std::thread([this, &generator, t, nThreads] {
+      generator.gather(WS.grid, im_size, &WS.GI[0], WS.Mnb, t, nThreads);
+    }));
+  for (int t = 0; t < nThreads; ++t)
+    threads[t].join();
+}
+
+template <typename Generator>
+void Parameterization::compareSamplers(const Generator& generator, Surface_mesh& Mesh_2D) {
+  // keep the gathered samples aside and run the scatter sampler into the workspace buffers
+  int nChannels = Generator::channels;
+  std::vector<cv::Mat> gathered(nChannels);
+  cv::Mat gatheredMnb = WS.Mnb.clone();
+  for (int ch = 0; ch < nChannels; ++ch)
+    gathered[ch] = WS.GI[ch].clone();
+  WS.acquireGI(im_size, nChannels);
+  generator.scatter(Mesh_2D, im_size, &WS.GI[0], WS.Mnb);
+
+  // compare the averaged scatter samples with the gathered ones on pixels covered by both
+  int nGather = cv::countNonZero(gatheredMnb);
+  int nScatter = cv::countNonZero(WS.Mnb);
+  int nBoth = 0;
+  std::vector<double> maxDiff(nChannels, 0), sumDiff(nChannels, 0);
+  // the labels are not summed by the scatter sampler, so they are not averaged here either
+  std::vector<char> averaged(nChannels, 1);
+  for (std::size_t l = 0; l < WS.layout.size(); ++l)
+    for (int ch = WS.layout[l].offset; ch < WS.layout[l].offset + WS.layout[l].channels; ++ch)
+      averaged[ch] = WS.layout[l].encoding != GI_LABEL;
+  for (int r_idx = 0; r_idx < im_size; ++r_idx) {
+    for (int c_idx = 0; c_idx < im_size; ++c_idx) {
+      float nb = WS.Mnb.at<float>(r_idx, c_idx);
+      if (nb == 0 || gatheredMnb.at<float>(r_idx, c_idx) == 0)
+        continue;
+      nBoth++;
+      for (int ch = 0; ch < nChannels; ++ch) {
+        double diff = std::abs(WS.GI[ch].at<float>(r_idx, c_idx) / (averaged[ch] ? nb : 1) - gathered[ch].at<float>(r_idx, c_idx));
+        maxDiff[ch] = std::max(maxDiff[ch], diff);
+        sumDiff[ch] += diff;
+      }
+    }
+  }
+
+  // one max and mean difference per attribute
+  LogFile << "samplerCheck," << nGather << "," << nScatter << "," << nBoth;
+  for (std::size_t l = 0; l < WS.layout.size(); ++l) {
+    double maxD = 0, sumD = 0;
+    for (int ch = WS.layout[l].offset; ch < WS.layout[l].offset + WS.layout[l].channels; ++ch) {
+      maxD = std::max(maxD, maxDiff[ch]);
+      sumD += sumDiff[ch];
+    }
+    double meanD = nBoth ? sumD / (WS.layout[l].channels * nBoth) : 0;
+    LogFile << "," << WS.layout[l].name << "," << maxD << "," << meanD;
+    if (l == 0)
+      Progress() << ", samplerDiff " << maxD;
+  }
+  LogFile << "\n";
+
+  // the gathered samples remain the output
+  gatheredMnb.copyTo(WS.Mnb);
+  for (int ch = 0; ch < nChannels; ++ch)
+    gathered[ch].copyTo(WS.GI[ch]);
+}
+
 void Parameterization::filterOutputMap(cv::Mat&A, cv::Mat& mask_value, cv::Mat&mask_NaN,
     cv::Mat& kernel, int nIter) {
   // compute mean of value outputMap and fed those values to NaN
   float mean_outValue = cv::mean(A, mask_value)[0];
-  cv::Mat out_tmp(A.size(), A.type(), cv::Scalar(mean_outValue));
-  out_tmp.copyTo(A, mask_NaN);
-  out_tmp.release();
+  A.setTo(cv::Scalar(mean_outValue), mask_NaN);
 
   // Perform convolution using a ones filter
-  cv::Mat outputMapTmp;
+  cv::Mat& outputMapTmp = WS.filterTmp;
   A.copyTo(outputMapTmp);
   for (int i = 0; i < nIter; i++) {
     cv::filter2D(outputMapTmp, outputMapTmp, -1, kernel, cv::Point(-1, -1),
@@ -431,14 +868,9 @@ void Parameterization::filterOutputMap(cv::Mat&A, cv::Mat& mask_value, cv::Mat&m
     A.copyTo(outputMapTmp, mask_value);
   }
   outputMapTmp.copyTo(A);
-  outputMapTmp.release();
 }
 
-void Parameterization::combineNSave(std::map<int, cv::Mat> &outMap, std::string meshFileFlatGI, std::string desc) {
-  // this check is to ensure any of the previous files are not overwritten
-  if(outfileExists(meshFileFlatGI, 10, desc+"ED"))
-    return;
-
+void Parameterization::combineNSave(cv::Mat outMap[3], const GIChannels& L, std::string meshFileFlatGI, std::string desc) {
   // statistics for the three channels
   double minVal[3];
   double maxVal[3];
@@ -449,17 +881,34 @@ void Parameterization::combineNSave(std::map<int, cv::Mat> &outMap, std::string
     // subtract with the min so that the new min is Zero, equivalent to translation in 3D
     cv::subtract(outMap[dim], minVal[dim], outMap[dim]);
   }
+  // kept for the vertex table, which maps the pixel values back to the slice
+  if (L.name == GIPosition::name()) {
+    for (int dim = 0; dim < 3; ++dim)
+      giMin[dim] = minVal[dim];
+    giScale = newMax(minVal, maxVal);
+  }
+  // and for the statistics, also when the GI itself is already on disk
+  std::vector<double>& range = ranges[L.name];
+  range.assign(minVal, minVal + 3);
+  range.insert(range.end(), maxVal, maxVal + 3);
+
+  // this check is to ensure any of the previous files are not overwritten
+  if(outfileExists(meshFileFlatGI, 10, desc+"ED")) {
+    addStats(L.name, meshFileFlatGI);
+    return;
+  }
 
   cv::Mat in[] = { outMap[2], outMap[1], outMap[0] };
   int from_to[] = { 0, 0, 1, 1, 2, 2 };
-  cv::Mat M = cv::Mat::zeros(im_size, im_size, CV_32FC3); // 3D Geometry Image
+  cv::Mat& M = WS.M; // 3D Geometry Image
+  M.create(im_size, im_size, CV_32FC3);
   cv::mixChannels(in, 3, &M, 1, from_to, 3);
 
   // divide by maximum so that new maximum is one
   // equivalent to uniform scaling as it is applied to all the dimensions
   cv::divide(M, newMax(minVal, maxVal), M);
 
-  cv::Mat MM(im_size, im_size, CV_8UC3);
+  cv::Mat& MM = WS.MM;
   M.convertTo(MM, CV_8UC3, 255);
   // scale to 255 is required or else image wont be visible in other viewer
 
@@ -469,8 +918,191 @@ void Parameterization::combineNSave(std::map<int, cv::Mat> &outMap, std::string
   compression_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
   compression_params.push_back(0);
 
-  cv::imwrite(meshFileFlatGI, MM, compression_params);
-  std::cout << desc << std::flush;
+  writeImage(meshFileFlatGI, MM, compression_params, LogFile);
+  if (!Flag.giStats.empty())
+    WS.stats.add(L.name, MM, minVal, maxVal, WS.copies);
+  Progress() << desc;
+}
+
+void Parameterization::encodeNSave(cv::Mat* outMap, const GIChannels& L, std::string meshFileGI, std::string desc) {
+  // channels are stored reversed so that the first channel ends up as red in the BGR image
+  std::vector<cv::Mat> in(outMap, outMap + L.channels);
+  std::reverse(in.begin(), in.end());
+
+  // range of every image channel before it is stretched, kept for the statistics
+  std::vector<double> rawMin(L.channels), rawMax(L.channels);
+  if (L.encoding == GI_RANGE) {
+    for (int k = 0; k < L.channels; ++k)
+      cv::minMaxLoc(in[k], &rawMin[k], &rawMax[k]);
+    std::vector<double>& range = ranges[L.name];
+    range.assign(rawMin.begin(), rawMin.end());
+    range.insert(range.end(), rawMax.begin(), rawMax.end());
+  }
+
+  // this check is to ensure any of the previous files are not overwritten
+  if(outfileExists(meshFileGI, 10, desc+"ED")) {
+    addStats(L.name, meshFileGI);
+    return;
+  }
+
+  cv::Mat& M = WS.M;
+  cv::merge(in, M);
+
+  cv::Mat& MM = WS.MM;
+  if (L.encoding == GI_RANGE) {
+    // each channel is stretched to the full 8 bit range on its own
+    std::vector<cv::Mat> planes;
+    cv::split(M, planes);
+    for (std::size_t k = 0; k < planes.size(); ++k)
+      cv::normalize(planes[k], planes[k], 0, 255, cv::NORM_MINMAX);
+    cv::merge(planes, M);
+    M.convertTo(MM, CV_8U);
+  }
+  else if (L.encoding == GI_LABEL)
+    // rounded and saturated to 16 bit so that labels above 255 survive
+    M.convertTo(MM, CV_16U);
+  else
+    M.convertTo(MM, CV_8U);
+
+  std::vector<int> compression_params;
+  compression_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+  compression_params.push_back(0);
+  writeImage(meshFileGI, MM, compression_params, LogFile);
+  if (!Flag.giStats.empty()) {
+    if (L.encoding == GI_RANGE)
+      WS.stats.add(L.name, MM, &rawMin[0], &rawMax[0], WS.copies);
+    else
+      WS.stats.add(L.name, MM, NULL, NULL, WS.copies);
+  }
+  Progress() << desc;
+}
+
+void Parameterization::maskNSave(cv::Mat& mask, std::string meshFileMask, std::string desc) {
+  // this check is to ensure any of the previous files are not overwritten
+  if(outfileExists(meshFileMask, 10, desc+"ED"))
+    return;
+  boost::system::error_code ec;
+  fs::create_directories(fs::path(meshFileMask).parent_path(), ec);
+  std::vector<int> compression_params;
+  compression_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+  compression_params.push_back(0);
+  writeImage(meshFileMask, mask, compression_params, LogFile);
+  Progress() << desc;
+}
+
+void Parameterization::normalMaskNSave(std::string meshFileNormalGI, std::string meshFileMask, std::string desc) {
+  if(outfileExists(meshFileMask, 10, desc+"ED"))
+    return;
+  // the mask is computed from the normals as they are stored, like python/data/generateMask.py does
+  cv::Mat normalImg = readImage(meshFileNormalGI, cv::IMREAD_UNCHANGED);
+  if (normalImg.empty() || normalImg.channels() != 3) {
+    LogFile << "Unable to read " << meshFileNormalGI << " for the normal mask\n";
+    return;
+  }
+  cv::Mat N;
+  normalImg.convertTo(N, CV_32FC3, 1.0 / 255);
+
+  // mean angle to the diagonal neighbours, the neighbourhood of scalarMask in generateMask.py
+  cv::Mat& A = WS.filterTmp;
+  A.create(N.rows, N.cols, CV_32F);
+  for (int r = 0; r < N.rows; ++r) {
+    for (int c = 0; c < N.cols; ++c) {
+      const cv::Vec3f& v0 = N.at<cv::Vec3f>(r, c);
+      float angleSum = 0;
+      int pixelCount = 0;
+      for (int rr = r - 1; rr <= r + 1; rr += 2) {
+        for (int cc = c - 1; cc <= c + 1; cc += 2) {
+          if (rr < 0 || rr >= N.rows || cc < 0 || cc >= N.cols)
+            continue;
+          ++pixelCount;
+          const cv::Vec3f& v1 = N.at<cv::Vec3f>(rr, cc);
+          float d = v0.dot(v1);
+          float angle;
+          if (d == 0)
+            angle = 1.57f;
+          else if (v0 == v1)
+            angle = 0;
+          else
+            angle = std::acos(d / (cv::norm(v0) * cv::norm(v1)));
+          if (std::isnan(angle))
+            continue;
+          angleSum += std::abs(angle);
+        }
+      }
+      A.at<float>(r, c) = pixelCount ? angleSum / pixelCount : 0;
+    }
+  }
+
+  // scale to [0,1] and store 8 bit
+  cv::normalize(A, A, 0, 255, cv::NORM_MINMAX);
+  cv::Mat& MM = WS.MM;
+  A.convertTo(MM, CV_8U);
+  maskNSave(MM, meshFileMask, desc);
+}
+
+void Parameterization::addStats(std::string name, std::string meshFileGI) {
+  // fold a GI which is already on disk into the statistics, its value range is the one of the
+  // sampling (mesh units), as for the GIs written by this run
+  if (Flag.giStats.empty())
+    return;
+  cv::Mat img = readImage(meshFileGI, cv::IMREAD_UNCHANGED);
+  if (img.empty()) {
+    LogFile << "Unable to read " << meshFileGI << " for statistics\n";
+    return;
+  }
+  std::map<std::string, std::vector<double> >::const_iterator range = ranges.find(name);
+  if (range != ranges.end() && range->second.size() == 2 * (std::size_t) img.channels())
+    WS.stats.add(name, img, &range->second[0], &range->second[img.channels()], WS.copies);
+  else
+    WS.stats.add(name, img, NULL, NULL, WS.copies);
+}
+
+fs::path Parameterization::rangeFile() {
+  fs::path file = GIFile("range");
+  return file.replace_extension(".txt");
+}
+
+bool Parameterization::readRanges() {
+  // one line per GI: name, number of channels, the minima and the maxima of the channels
+  std::string bytes;
+  if (!readFile(rangeFile(), bytes))
+    return false;
+  std::istringstream in(bytes);
+  std::string name;
+  std::size_t n;
+  while (in >> name >> n) {
+    std::vector<double> range(2 * n);
+    for (std::size_t k = 0; k < range.size(); ++k)
+      in >> range[k];
+    if (!in)
+      return false;
+    ranges[name] = range;
+  }
+  return true;
+}
+
+bool Parameterization::writeRanges() {
+  std::ostringstream out;
+  out.precision(9);
+  for (std::map<std::string, std::vector<double> >::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
+    out << it->first << " " << it->second.size() / 2;
+    for (std::size_t k = 0; k < it->second.size(); ++k)
+      out << " " << it->second[k];
+    out << "\n";
+  }
+  return writeFile(rangeFile(), out.str(), LogFile);
+}
+
+std::string Parameterization::GIFile(std::string name) {
+  return (paramFile.parent_path() / paramFile.stem()).string() + "_" + std::to_string(im_size) + "_" + name + ".png";
+}
+
+std::string Parameterization::maskFile(std::string name) {
+  // masks go to <GI folder>_msk, where python/data/loaders.py looks for them
+  std::string folder = paramFile.parent_path().string();
+  while (folder.size() > 1 && folder[folder.size() - 1] == '/')
+    folder.erase(folder.size() - 1);
+  return (fs::path(folder + "_msk") / paramFile.stem()).string() + "_" + std::to_string(im_size) + "_" + name + ".png";
 }
 
 double Parameterization::newMax(double minVal[3], double maxVal[3]) {
@@ -506,7 +1138,7 @@ bool Parameterization::readGI(int downScaleFactor) {
   if (!useNormal)
     normalImg.release();
 
-  Img = cv::imread(paramFile_flatGI, cv::IMREAD_UNCHANGED);
+  Img = readImage(paramFile_flatGI, cv::IMREAD_UNCHANGED);
   assert(downScaleFactor!= 0);
   if (downScaleFactor!= 1)
     cv::resize(Img, Img, cv::Size(Img.cols/downScaleFactor, Img.rows/downScaleFactor), 0, 0, CV_INTER_LINEAR);
@@ -514,7 +1146,7 @@ bool Parameterization::readGI(int downScaleFactor) {
 
   double minNormalImg, maxNormalImg;
   if (useNormal)  {
-    normalImg = cv::imread(paramFile_nflatGI, cv::IMREAD_UNCHANGED); //, cv::IMREAD_ANYDEPTH); ////CV_LOAD_IMAGE_COLOR);
+    normalImg = readImage(paramFile_nflatGI, cv::IMREAD_UNCHANGED); //, cv::IMREAD_ANYDEPTH); ////CV_LOAD_IMAGE_COLOR);
     if (downScaleFactor!= 1)
       cv::resize(normalImg, normalImg, cv::Size(normalImg.cols/downScaleFactor, normalImg.rows/downScaleFactor), 0, 0, CV_INTER_LINEAR);
     cv::minMaxLoc(normalImg, &minNormalImg, &maxNormalImg, NULL, NULL);
@@ -529,6 +1161,8 @@ bool Parameterization::readGI(int downScaleFactor) {
 
   int n_rows = Img.rows;
   int n_cols = Img.cols;
+  gi_rows = n_rows;
+  gi_cols = n_cols;
 
   // iterating for all the pixels of image
   for (int i = 0; i < n_rows; i++) {
@@ -571,9 +1205,9 @@ bool Parameterization::addVerticestoSM(Surface_mesh& sm)  {
     try
     {
       pt = Point_3(
-          boost::lexical_cast<double>(pointVector[0]),
-          boost::lexical_cast<double>(pointVector[1]),
-          boost::lexical_cast<double>(pointVector[2]));
+          boost::lexical_cast<Scalar>(pointVector[0]),
+          boost::lexical_cast<Scalar>(pointVector[1]),
+          boost::lexical_cast<Scalar>(pointVector[2]));
     }
     catch (boost::bad_lexical_cast &)
     {
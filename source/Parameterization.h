@@ -11,10 +11,9 @@
 #define PARAMETERIZATION_H_
 
 #include "include.h"
-
-#include <CGAL/Unique_hash_map.h>
-typedef CGAL::Unique_hash_map<vertex_descriptor, Point_2> UV_uhm;
-typedef boost::associative_property_map<UV_uhm> UV_pmap;
+#include "Workspace.h"
+#include "GIGenerator.h"
+#include "Welder.h"
 
 #include <CGAL/Surface_mesh_parameterization/Square_border_parameterizer_3.h>
 #include <CGAL/Surface_mesh_parameterization/Iterative_parameterize.h>
@@ -22,26 +21,73 @@ typedef boost::associative_property_map<UV_uhm> UV_pmap;
 namespace SMP = CGAL::Surface_mesh_parameterization;
 typedef SMP::Square_border_arc_length_parameterizer_3<Surface_mesh> Border_parameterizer;
 typedef SMP::Iterative_authalic_parameterizer_3<Surface_mesh, Border_parameterizer> Parameterizer;
+#include <CGAL/Surface_mesh_parameterization/Discrete_conformal_map_parameterizer_3.h>
+#include <CGAL/Surface_mesh_parameterization/parameterize.h>
+typedef SMP::Discrete_conformal_map_parameterizer_3<Surface_mesh, Border_parameterizer> Fast_parameterizer;
 namespace PMP = CGAL::Polygon_mesh_processing;
 #include <CGAL/Polygon_mesh_processing/compute_normal.h>
+#include <CGAL/AABB_tree.h>
+#include <CGAL/AABB_traits.h>
+#include <CGAL/AABB_face_graph_triangle_primitive.h>
+typedef CGAL::AABB_face_graph_triangle_primitive<Surface_mesh> AABB_primitive;
+typedef CGAL::AABB_tree<CGAL::AABB_traits<Kernel, AABB_primitive> > AABB_tree;
+
+#include <atomic>
+#include <map>
+#include <thread>
 
 class Parameterization {
 public:
-  Parameterization(std::stringstream & LogFile, fs::path inputPath, fs::path outputPath, bool &useNormal, int &im);
+  Parameterization(std::stringstream & LogFile, Workspace & WS, fs::path inputPath, fs::path outputPath, flag &Flag);
   virtual ~Parameterization();
   bool surfaceParameteriseIterative(int iterations);
   bool mesh2GI();
   bool GI2off();
+  bool GI2off(const cv::Mat& GI);
+  bool applyGI();
 
 
 private:
+  // forwards the attribute list chosen by GISelect to sampleGI
+  struct GIDispatch {
+    Parameterization* PM;
+    Surface_mesh* Mesh_3D;
+    Surface_mesh* Mesh_2D;
+    template <typename... Attrs> bool run() { return PM->sampleGI<Attrs...>(*Mesh_3D, *Mesh_2D); }
+  };
+  bool GI2offBatch();
+  bool readNpy(fs::path npyFile, std::vector<cv::Mat>& GIs);
+  bool loadNSample();
+  bool loadFlat(Surface_mesh& Mesh_3D, Surface_mesh& Mesh_2D);
+  bool readSampleMap(std::size_t nVertices);
+  fs::path sampleMapFile();
+  fs::path vertexTableFile();
+  void vertexPixels(Surface_mesh& Mesh_2D);
+  bool writeVertexTable();
+  bool streamNSample();
+  template <typename... Attrs> bool sampleGI(Surface_mesh& Mesh_3D, Surface_mesh& Mesh_2D);
+  template <typename Generator> void gatherGI(const Generator& generator, Surface_mesh& Mesh_2D);
+  template <typename Generator> void compareSamplers(const Generator& generator, Surface_mesh& Mesh_2D);
   void filterOutputMap(cv::Mat&A, cv::Mat& mask_value, cv::Mat&mask_NaN, cv::Mat& kernel, int nIter);
-  void combineNSave(std::map<int, cv::Mat> &outMap, std::string meshFileFlatGI, std::string desc);
+  void combineNSave(cv::Mat outMap[3], const GIChannels& L, std::string meshFileFlatGI, std::string desc);
+  void encodeNSave(cv::Mat* outMap, const GIChannels& L, std::string meshFileGI, std::string desc);
+  void maskNSave(cv::Mat& mask, std::string meshFileMask, std::string desc);
+  void normalMaskNSave(std::string meshFileNormalGI, std::string meshFileMask, std::string desc);
+  void addStats(std::string name, std::string meshFileGI);
+  fs::path rangeFile();
+  bool readRanges();
+  bool writeRanges();
+  std::string GIFile(std::string name);
+  std::string maskFile(std::string name);
   double newMax(double minVal[3], double maxVal[3]);
   bool readGI(int downScaleFactor=1);
   bool addVerticestoSM(Surface_mesh& sm);
+  bool weldNSave(Surface_mesh& sm, fs::path meshFile);
+  void distortion(Surface_mesh& sm, SM_uvmap& uv_map, double& areaDist, double& angleDist);
 
   std::stringstream& LogFile;
+  Workspace& WS;  // reusable storage of the current worker
+  flag& Flag; // program flags
   fs::path inputPath; // input path
   bool useNormal; // use normals with geometry image
   int im_size;
@@ -50,6 +96,11 @@ private:
   std::string paramFile_flatGI; // vertex encoded geometry image
   std::string paramFile_nflatGI;  // normal encoded geometry image
   fs::path paramFile_flatGI_off; // remeshed pointcloud
+  int gi_rows, gi_cols;  // size of the GI read by readGI
+  bool resampling;  // mesh2GI samples from the sampling map instead of the flat mesh
+  std::vector<float> vertexPx;  // row and column of every vertex in the GI, with --vertexTable
+  double giMin[3], giScale; // normalization of the position GI, pixel value v is min + v*scale
+  std::map<std::string, std::vector<double> > ranges;  // per GI the channel minima then maxima before encoding
 
   std::stringstream verticesSS, normalSS, faceSS; //strings to read mesh from GI
 };
@@ -0,0 +1,107 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Prefetcher.h"
+
+Prefetcher::Prefetcher(const std::vector<fs::path>& modelFilePathList, int depth, std::size_t maxBytes):
+modelFilePathList(modelFilePathList), depth(std::max(1, depth)), maxBytes(maxBytes), bytes(0), stop(false) {
+  loader = std::thread(&Prefetcher::run, this);
+}
+
+Prefetcher::~Prefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  notFull.notify_all();
+  loader.join();
+}
+
+void Prefetcher::take(Workspace& WS) {
+  // items are produced in list order, so the front of the queue is always the current file
+  std::shared_ptr<item> it;
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    notEmpty.wait(lock, [this] { return !queue.empty(); });
+    it = queue.front();
+    queue.pop_front();
+    bytes -= it->bytes;
+  }
+  notFull.notify_one();
+
+  if (it->loaded)
+    WS.setPrefetched(it->path, it->sm);
+}
+
+void Prefetcher::run() {
+  for (std::size_t i = 0; i < modelFilePathList.size(); ++i) {
+    std::shared_ptr<item> it(new item);
+    it->path = modelFilePathList[i];
+    it->loaded = false;
+    it->bytes = 0;
+
+    // only meshes are parsed ahead, the stages load anything else themselves
+    // errors are left for the stage to report when it loads the file again
+    bool isMesh = it->path.extension() == ".off" && fs::is_regular_file(it->path);
+
+    // the item is admitted with the estimate before it is parsed, so the parsed meshes stay
+    // within the cap; the estimate is replaced by the parsed size once the item is queued
+    std::size_t estimate = isMesh ? fileBytes(it->path) : 0;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      notFull.wait(lock, [this, estimate] {
+        return stop || (queue.size() < (std::size_t) depth && (queue.empty() || bytes + estimate <= maxBytes));
+      });
+      if (stop)
+        return;
+      bytes += estimate;
+    }
+
+    std::chrono::high_resolution_clock::time_point begin_l = std::chrono::high_resolution_clock::now();
+    if (isMesh) {
+      fs::ifstream in_fs(it->path);
+      try {
+        it->loaded = in_fs && (in_fs >> it->sm) && it->sm.number_of_vertices() > 0;
+      } catch (...) {
+        it->loaded = false;
+      }
+      if (it->loaded)
+        it->bytes = meshBytes(it->sm);
+      else
+        it->sm.clear();
+      Logger::metrics kv;
+      Logger::metric(kv, "loaded", it->loaded);
+      Logger::metric(kv, "bytes", it->bytes);
+      Log.log(Logger::INFO, it->path.string(), "prefetch",
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()-begin_l).count() / 1000.0,
+          "", kv);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      bytes = bytes - estimate + it->bytes;
+      queue.push_back(it);
+    }
+    notEmpty.notify_one();
+  }
+}
+
+std::size_t Prefetcher::fileBytes(const fs::path& file) {
+  // an OFF line of a vertex or a face takes about half the memory of its parsed elements
+  boost::system::error_code ec;
+  uintmax_t size = fs::file_size(file, ec);
+  return ec ? 0 : 2 * (std::size_t) size;
+}
+
+std::size_t Prefetcher::meshBytes(const Surface_mesh& sm) {
+  // point and halfedge per vertex, face, vertex, next and prev per halfedge, halfedge per face
+  return sm.number_of_vertices() * (sizeof(Point_3) + sizeof(int))
+      + sm.number_of_halfedges() * 4 * sizeof(int)
+      + sm.number_of_faces() * sizeof(int);
+}
@@ -0,0 +1,53 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef PREFETCHER_H_
+#define PREFETCHER_H_
+
+#include "include.h"
+#include "Workspace.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Loader thread which parses the meshes of the file list ahead of the batch loop into a
+// bounded queue, so that reading the next file overlaps with processing the current one
+class Prefetcher {
+public:
+  Prefetcher(const std::vector<fs::path>& modelFilePathList, int depth, std::size_t maxBytes);
+  virtual ~Prefetcher();
+  void take(Workspace& WS);
+
+private:
+  struct item {
+    fs::path path;
+    bool loaded;  // false if the file is not a mesh or could not be parsed
+    std::size_t bytes;  // estimated memory held by the mesh
+    Surface_mesh sm;
+  };
+  void run();
+  static std::size_t fileBytes(const fs::path& file);
+  static std::size_t meshBytes(const Surface_mesh& sm);
+
+  const std::vector<fs::path>& modelFilePathList;
+  int depth;  // maximum number of items held in the queue
+  std::size_t maxBytes; // maximum memory held in the queue, one item is always allowed
+  // (a soft cap: items are admitted by an estimate from their file size, and a single item larger
+  // than the cap is still loaded when the queue is empty)
+  std::size_t bytes;  // memory currently held in the queue
+  bool stop;
+  std::deque<std::shared_ptr<item> > queue;
+  std::mutex mtx;
+  std::condition_variable notFull, notEmpty;
+  std::thread loader;
+};
+
+#endif /* PREFETCHER_H_ */
@@ -8,8 +8,10 @@
  ***************************************************************************************/
 
 #include "Preprocess.h"
+#include "Pack.h"
 
-Preprocess::Preprocess(std::stringstream & LogFile, fs::path inputPath, fs::path outputPath): LogFile(LogFile) {
+Preprocess::Preprocess(std::stringstream & LogFile, Workspace & WS, fs::path inputPath, fs::path outputPath, flag &Flag):
+LogFile(LogFile), WS(WS), Flag(Flag), nThreads(std::max(1u, std::thread::hardware_concurrency())) {
   this->inputPath = inputPath;
   this->outputPath = (outputPath / inputPath.stem()).string() + ".off";
   this->bdebug = false;
@@ -20,29 +22,82 @@ Preprocess::~Preprocess() {
 }
 
 bool Preprocess::slice()  {
-  // check if output file already exists
-  if(outfileExists(outputPath, 10, " ,sliced"))
+  // without --planes the x-midplane keeping +x, written under the name of the input
+  std::vector<slicePlane> planes = Flag.planes;
+  std::vector<fs::path> outPaths;
+  if (planes.empty()) {
+    slicePlane sp = { { 1, 0, 0 }, 0, "" };
+    planes.push_back(sp);
+    outPaths.push_back(outputPath);
+  }
+  else {
+    for (std::size_t k = 0; k < planes.size(); ++k)
+      outPaths.push_back(outputPath.parent_path() / (outputPath.stem().string() + "_" + planes[k].tag + ".off"));
+  }
+
+  // check if output files already exist
+  std::vector<int> pending;
+  for (std::size_t k = 0; k < planes.size(); ++k) {
+    if (!outfileExists(outPaths[k], 10, " ,sliced"))
+      pending.push_back(k);
+  }
+  if (pending.empty())
     return true;
 
   // read input
-  Surface_mesh inMesh;
-  if(!meshLoader(inputPath, inMesh, " input mesh for slicing", LogFile, bdebug))
+  Surface_mesh& inMesh = WS.acquireMesh(Workspace::MESH_3D);
+  if(!WS.loadInput(inputPath, inMesh, " input mesh for slicing", LogFile, bdebug))
     return false;
+  CGAL::Bbox_3 box = bbox(inMesh);
+
+  if (pending.size() == 1) {
+    if (!clipNSave(inMesh, planes[pending[0]], box, outPaths[pending[0]]))
+      return false;
+    Progress() << ", slice";
+    return true;
+  }
+
+  // one thread per plane, each clips its own copy of the loaded mesh and runs the cleaning
+  // chain with its own workspace and share of the cores, the logs are appended in the order
+  // of the planes
+  std::vector<std::stringstream> planeLogs(pending.size());
+  std::vector<char> ok(pending.size(), 0);
+  std::vector<std::thread> threads;
+  for (std::size_t k = 0; k < pending.size(); ++k) {
+    threads.push_back(std::thread([&, k]() {
+      Workspace planeWS;
+      Surface_mesh& sm = planeWS.acquireMesh(Workspace::MESH_3D);
+      sm = inMesh;
+      Preprocess PP(planeLogs[k], planeWS, inputPath, outputPath.parent_path(), Flag);
+      PP.nThreads = std::max(1, nThreads / (int) pending.size());
+      ok[k] = PP.clipNSave(sm, planes[pending[k]], box, outPaths[pending[k]]);
+    }));
+  }
+  bool allOk = true;
+  for (std::size_t k = 0; k < threads.size(); ++k) {
+    threads[k].join();
+    if (!ok[k])
+      LogFile << planes[pending[k]].tag << ": ";
+    LogFile << planeLogs[k].str();
+    allOk = allOk && ok[k];
+  }
+  Progress() << ", slice " << pending.size() << " planes";
+  return allOk;
+}
 
-  CGAL::Bbox_3 bbox = PMP::bbox(inMesh);
-  double slicePlane;
-  slicePlane = (bbox.xmin()+bbox.xmax())/2;
-  K_Plane_3 plane(1,0,0,-slicePlane);
 
-  // Check the direction of the plane and orient it to the negative x axis
-  // such that the slice is present on the positive x axis
-  Kernel::Direction_3 dir = plane.orthogonal_direction();
-  if(dir.dx()>0)
-    plane = plane.opposite();
+// private
+bool Preprocess::clipNSave(Surface_mesh& sm, const slicePlane& sp, const CGAL::Bbox_3& bbox, fs::path filepath) {
+  // plane through the bounding box center moved by the offset, oriented such that its
+  // negative side, the one kept by clip, is the side sp.n points into
+  Kernel::Vector_3 n(sp.n[0], sp.n[1], sp.n[2]);
+  Point_3 center((bbox.xmin()+bbox.xmax())/2, (bbox.ymin()+bbox.ymax())/2, (bbox.zmin()+bbox.zmax())/2);
+  Point_3 onPlane = center + Scalar(sp.offset) * n;
+  K_Plane_3 plane(onPlane, -n);
 
   // clip the mesh with the plane
   try{
-    PMP::clip(inMesh, plane);
+    PMP::clip(sm, plane);
   }
   catch(...)  {
     std::cerr << "unable to slice mesh\n";
@@ -50,98 +105,401 @@ bool Preprocess::slice()  {
     return false;
   }
 
-  // also do the translation in x so that the new xMin is zero
-  // this is done later as the close holes might add some vertices near to the
-  Kernel::Vector_3 K_translateVector(Point_3(slicePlane,0.0,0.0),Point_3(0.0,0.0,0.0));
-  K_AffineTran t(CGAL::TRANSLATION,K_translateVector);
-  BOOST_FOREACH(vertex_descriptor vd, inMesh.vertices())  {
-    inMesh.point(vd) = inMesh.point(vd).transform(t);
+  // rotate n onto +x and translate in x so that the plane is at x = 0, the slice is then on
+  // the positive x axis as every later stage expects; the x-midplane is only translated
+  double R[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+  double c = sp.n[0];
+  if (c < -1 + 1e-12) {
+    // half turn about y
+    R[0][0] = -1;
+    R[2][2] = -1;
+  }
+  else if (c < 1 - 1e-12) {
+    // Rodrigues rotation about n x e_x
+    double v[3] = { 0, sp.n[2], -sp.n[1] };
+    double V[3][3] = { { 0, -v[2], v[1] }, { v[2], 0, -v[0] }, { -v[1], v[0], 0 } };
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j) {
+        double V2 = 0;
+        for (int l = 0; l < 3; ++l)
+          V2 += V[i][l] * V[l][j];
+        R[i][j] += V[i][j] + V2 / (1 + c);
+      }
   }
+  Scalar shift = (onPlane - CGAL::ORIGIN) * n;
+  K_AffineTran t(R[0][0], R[0][1], R[0][2], -shift,
+      R[1][0], R[1][1], R[1][2], 0,
+      R[2][0], R[2][1], R[2][2], 0);
+  // every vertex is moved on its own, the clipped away ones are skipped
+  parallelFor(sm.num_vertices(), [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      vertex_descriptor vd(i);
+      if (!sm.is_removed(vd))
+        sm.point(vd) = sm.point(vd).transform(t);
+    }
+  });
 
   // save the slice while closing holes
-  if(!saveSlice(outputPath, inMesh))
-    return false;
-  std::cout << ", slice" << std::flush;
-  return true;
+  return saveSlice(filepath, sm);
 }
 
-
-// private
 bool Preprocess::saveSlice(fs::path & filepath, Surface_mesh &sm) {
   // redundant cleaning steps are required to avoid any holes or non-manifoldness in the output
+  // meshlab works on files, so a packed slice is cleaned in the temporary folder and only the
+  // cleaned slice is added to the pack
+  fs::path cleanPath = filepath;
+  if (Pack::writer(filepath))
+    cleanPath = fs::temp_directory_path() / fs::unique_path("%%%%-%%%%-%%%%-" + filepath.filename().string());
 
   // 1. CGAL based refining
   refineOnly(sm);
-  if(!saveMesh(filepath, sm, ", refined mesh", LogFile))
-    return false;
+  bool ok = saveMesh(cleanPath, sm, ", refined mesh", LogFile);
 
   // 2. Meshlab based non-manifold removal
-  if(!MLS(filepath, filepath, "source/cleanSlice", " slice cleaning", LogFile))
-    return false;
+  ok = ok && MLS(cleanPath, cleanPath, "source/cleanSlice", " slice cleaning", LogFile);
 
   // 3. CGAL based hole closing, for holes created by non-manifoldness removal
-  if(!closeHoles(filepath))
-    return false;
+  ok = ok && closeHoles(cleanPath);
 
-  return true;
+  if (cleanPath != filepath) {
+    std::ifstream in(cleanPath.string().c_str(), std::ios::binary);
+    std::stringstream bytes;
+    bytes << in.rdbuf();
+    ok = ok && writeFile(filepath, bytes.str(), LogFile);
+    fs::remove(cleanPath);
+  }
+  return ok;
 }
 
 void Preprocess::refineOnly(Surface_mesh &sm) {
   // connected comp
-  PMP::keep_largest_connected_components(sm, 1, CGAL::parameters::all_default());
+  keepLargestComponent(sm);
 
   //refine
   std::vector<vertex_descriptor> newVertices;
   std::vector<face_descriptor> newFaces;
   PMP::refine(sm, faces(sm),
       std::back_inserter(newFaces),
-      std::back_inserter(newVertices));
+      std::back_inserter(newVertices),
+      PMP::parameters::density_control_factor(Flag.refineDensity));
+}
+
+bool Preprocess::reorder(Surface_mesh& sm) {
+  // drop removed elements and renumber vertices and faces along a Morton curve, so that
+  // elements close in space are close in memory
+  sm.collect_garbage();
+  CGAL::Bbox_3 bbox = PMP::bbox(sm);
+  double extent = std::max(bbox.xmax() - bbox.xmin(), std::max(bbox.ymax() - bbox.ymin(), bbox.zmax() - bbox.zmin()));
+  if (extent <= 0)
+    return false;
+  double scale = ((1 << 21) - 1) / extent;
+  auto morton = [&](double x, double y, double z) {
+    return spreadBits((uint64_t) ((x - bbox.xmin()) * scale)) |
+        spreadBits((uint64_t) ((y - bbox.ymin()) * scale)) << 1 |
+        spreadBits((uint64_t) ((z - bbox.zmin()) * scale)) << 2;
+  };
+
+  std::vector<std::pair<uint64_t, vertex_descriptor> > vKeys;
+  vKeys.reserve(sm.number_of_vertices());
+  BOOST_FOREACH(vertex_descriptor vd, vertices(sm)) {
+    const Point_3& p = sm.point(vd);
+    vKeys.push_back(std::make_pair(morton(p.x(), p.y(), p.z()), vd));
+  }
+  std::sort(vKeys.begin(), vKeys.end());
+
+  std::vector<std::pair<uint64_t, face_descriptor> > fKeys;
+  fKeys.reserve(sm.number_of_faces());
+  BOOST_FOREACH(face_descriptor fd, faces(sm)) {
+    double c[3] = { 0, 0, 0 };
+    int n = 0;
+    BOOST_FOREACH(vertex_descriptor vd, vertices_around_face(sm.halfedge(fd), sm)) {
+      c[0] += sm.point(vd).x();
+      c[1] += sm.point(vd).y();
+      c[2] += sm.point(vd).z();
+      ++n;
+    }
+    fKeys.push_back(std::make_pair(morton(c[0] / n, c[1] / n, c[2] / n), fd));
+  }
+  std::sort(fKeys.begin(), fKeys.end());
+
+  // rebuild in the new order, the OFF writer keeps it
+  Surface_mesh& out = WS.acquireMesh(Workspace::MESH_TMP);
+  out.reserve(sm.number_of_vertices(), sm.number_of_edges(), sm.number_of_faces());
+  SM_vimap newIndex = sm.add_property_map<vertex_descriptor, int>("v:reorder").first;
+  for (std::size_t k = 0; k < vKeys.size(); ++k) {
+    out.add_vertex(sm.point(vKeys[k].second));
+    put(newIndex, vKeys[k].second, (int) k);
+  }
+  std::vector<vertex_descriptor> fVertices;
+  for (std::size_t k = 0; k < fKeys.size(); ++k) {
+    fVertices.clear();
+    BOOST_FOREACH(vertex_descriptor vd, vertices_around_face(sm.halfedge(fKeys[k].second), sm))
+      fVertices.push_back(vertex_descriptor(get(newIndex, vd)));
+    if (out.add_face(fVertices) == Surface_mesh::null_face()) {
+      // keep the original order rather than losing a face
+      sm.remove_property_map(newIndex);
+      LogFile << "reorder failed, original order kept\n";
+      return false;
+    }
+  }
+  sm.remove_property_map(newIndex);
+  // copied rather than moved, a moved-from mesh keeps handles into the arrays now owned by sm
+  // and the slot is reused by the next file
+  sm = out;
+  Progress() << ", reordered";
+  return true;
+}
+
+CGAL::Bbox_3 Preprocess::bbox(const Surface_mesh& sm) const {
+  // PMP::bbox over the vertices, each chunk reduces its own box and the boxes are merged
+  std::vector<CGAL::Bbox_3> boxes(sm.num_vertices() / grain + 1);
+  parallelFor(sm.num_vertices(), [&](std::size_t first, std::size_t last) {
+    CGAL::Bbox_3& box = boxes[first / grain];
+    for (std::size_t i = first; i < last; ++i) {
+      vertex_descriptor vd(i);
+      if (!sm.is_removed(vd))
+        box += sm.point(vd).bbox();
+    }
+  });
+  CGAL::Bbox_3 box;
+  for (std::size_t t = 0; t < boxes.size(); ++t)
+    box += boxes[t];
+  return box;
+}
+
+void Preprocess::keepLargestComponent(Surface_mesh& sm) const {
+  // PMP::keep_largest_connected_components(sm, 1) with the labeling done in parallel: the faces on
+  // both sides of every edge are joined in a lock-free union-find, a root always links to the
+  // smaller face index so concurrent unions can't form a cycle
+  std::size_t nF = sm.num_faces();
+  std::vector<std::atomic<uint32_t> > parent(nF);
+  parallelFor(nF, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  });
+  auto findRoot = [&](uint32_t f) {
+    uint32_t p;
+    while ((p = parent[f].load(std::memory_order_relaxed)) != f) {
+      // halve the path on the way, a stale value only costs another step
+      uint32_t gp = parent[p].load(std::memory_order_relaxed);
+      parent[f].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+      f = gp;
+    }
+    return f;
+  };
+  parallelFor(sm.num_edges(), [&](std::size_t first, std::size_t last) {
+    for (std::size_t e = first; e < last; ++e) {
+      halfedge_descriptor h(2 * e);
+      if (sm.is_removed(h))
+        continue;
+      face_descriptor f0 = sm.face(h), f1 = sm.face(sm.opposite(h));
+      if (f0 == Surface_mesh::null_face() || f1 == Surface_mesh::null_face())
+        continue;
+      uint32_t a = findRoot((std::size_t) f0), b = findRoot((std::size_t) f1);
+      while (a != b) {
+        if (a < b)
+          std::swap(a, b);
+        uint32_t expected = a;
+        if (parent[a].compare_exchange_weak(expected, b, std::memory_order_relaxed))
+          break;
+        a = findRoot(a);
+        b = findRoot(b);
+      }
+    }
+  });
+
+  // faces per component, counted at the root of each
+  std::vector<std::atomic<uint32_t> > size(nF);
+  parallelFor(nF, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      size[i].store(0, std::memory_order_relaxed);
+  });
+  parallelFor(nF, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      if (!sm.is_removed(face_descriptor(i)))
+        size[findRoot(i)].fetch_add(1, std::memory_order_relaxed);
+  });
+  uint32_t largest = 0;
+  for (std::size_t i = 1; i < nF; ++i)
+    if (size[i].load(std::memory_order_relaxed) > size[largest].load(std::memory_order_relaxed))
+      largest = i;
+  if (nF == 0 || size[largest].load(std::memory_order_relaxed) == sm.number_of_faces())
+    return;
+
+  // component 0 is kept, the removal itself stays with CGAL
+  Surface_mesh::Property_map<face_descriptor, std::size_t> fcc =
+      sm.add_property_map<face_descriptor, std::size_t>("f:lcc", 1).first;
+  parallelFor(nF, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      if (!sm.is_removed(face_descriptor(i)))
+        fcc[face_descriptor(i)] = findRoot(i) == largest ? 0 : 1;
+  });
+  PMP::keep_connected_components(sm, std::vector<std::size_t>(1, 0), fcc);
+  sm.remove_property_map(fcc);
+}
+
+bool Preprocess::patchFits(const Surface_mesh& sm, const std::vector<halfedge_descriptor>& cycle,
+    const std::vector<CGAL::Triple<int, int, int> >& patch) {
+  // the patch is a disk spanning the cycle: n - 2 triangles on n distinct border vertices, every
+  // cycle edge used once and every diagonal twice, and no diagonal already an edge of the mesh
+  std::size_t n = cycle.size();
+  if (n < 3 || patch.size() != n - 2)
+    return false;
+  std::vector<vertex_descriptor> vs(n);
+  for (std::size_t b = 0; b < n; ++b)
+    vs[b] = sm.source(cycle[b]);
+  std::vector<vertex_descriptor> sorted(vs);
+  std::sort(sorted.begin(), sorted.end());
+  if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+    return false;
+  std::map<std::pair<int, int>, int> uses;
+  for (std::size_t p = 0; p < patch.size(); ++p) {
+    int v[3] = { patch[p].first, patch[p].second, patch[p].third };
+    std::sort(v, v + 3);
+    if (v[0] < 0 || v[2] >= (int) n || v[0] == v[1] || v[1] == v[2])
+      return false;
+    ++uses[std::make_pair(v[0], v[1])];
+    ++uses[std::make_pair(v[1], v[2])];
+    ++uses[std::make_pair(v[0], v[2])];
+  }
+  for (std::map<std::pair<int, int>, int>::const_iterator it = uses.begin(); it != uses.end(); ++it) {
+    bool onCycle = it->first.second == it->first.first + 1 || (it->first.first == 0 && it->first.second == (int) n - 1);
+    if (it->second != (onCycle ? 1 : 2))
+      return false;
+    if (!onCycle && sm.halfedge(vs[it->first.first], vs[it->first.second]) != Surface_mesh::null_halfedge())
+      return false;
+  }
+  return true;
+}
+
+uint64_t Preprocess::spreadBits(uint64_t x) {
+  // insert two zero bits between the lower 21 bits of x
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
 }
 
 bool Preprocess::closeHoles(fs::path& filepath)  {
-  // read input
-  Surface_mesh sm;
+  // read input, the sliced mesh is still held in the 3D slot
+  Surface_mesh& sm = WS.acquireMesh(Workspace::MESH_2D);
   if(!meshLoader(filepath, sm, " input mesh for closeASML", LogFile, bdebug))
     return false;
 
-  // identify all the border vertices
-  std::vector<halfedge_descriptor> bHalfEdges;
-  PMP::border_halfedges(faces(sm), sm, std::back_inserter(bHalfEdges));
+  // identify all the border halfedges, the halfedges are scanned in parallel and the chunks
+  // are concatenated in halfedge order, so the cycles are the same on every run
+  std::size_t nH = sm.num_halfedges();
+  std::vector<std::vector<halfedge_descriptor> > found(nH / grain + 1);
+  parallelFor(nH, [&](std::size_t first, std::size_t last) {
+    std::vector<halfedge_descriptor>& mine = found[first / grain];
+    for (std::size_t i = first; i < last; ++i) {
+      halfedge_descriptor h(i);
+      if (!sm.is_removed(h) && sm.is_border(h))
+        mine.push_back(h);
+    }
+  });
 
-  // identify the longest border
-  std::vector<halfedge_descriptor> bLHalfEdges;
-  halfedge_descriptor bhd = PMP::longest_border(sm).first;
-  BOOST_FOREACH(halfedge_descriptor bh, halfedges_around_face(bhd, sm)) {
-    bLHalfEdges.push_back(bh);
+  // follow the borders to their cycles, the longest one is the border of the slice
+  std::vector<char> visited(nH, 0);
+  std::vector<std::vector<halfedge_descriptor> > cycles;
+  std::size_t longest = 0;
+  double longestLength = -1;
+  for (std::size_t t = 0; t < found.size(); ++t) {
+    for (std::size_t b = 0; b < found[t].size(); ++b) {
+      if (visited[(std::size_t) found[t][b]])
+        continue;
+      cycles.push_back(std::vector<halfedge_descriptor>());
+      double length = 0;
+      halfedge_descriptor h = found[t][b];
+      do {
+        visited[(std::size_t) h] = 1;
+        cycles.back().push_back(h);
+        length += std::sqrt(CGAL::to_double(CGAL::squared_distance(sm.point(sm.source(h)), sm.point(sm.target(h)))));
+        h = sm.next(h);
+      } while (h != found[t][b]);
+      if (length > longestLength) {
+        longestLength = length;
+        longest = cycles.size() - 1;
+      }
+    }
   }
 
-  int bCounter = bHalfEdges.size();
-  int bLCounter = bLHalfEdges.size();
+  if (cycles.size() > 1) {
+    std::vector<char> onLongest(nH, 0);
+    for (std::size_t b = 0; b < cycles[longest].size(); ++b)
+      onLongest[(std::size_t) cycles[longest][b]] = 1;
 
-  if(bCounter > bLCounter)  {
     // meaning that there are some vertices lying on border other than the largest border
-    // for those half-edges fill the holes
-    std::vector<halfedge_descriptor> bnLHalfEdges(bCounter-bLCounter);
-    BOOST_FOREACH(halfedge_descriptor h, halfedges(sm)) {
-      std::vector<halfedge_descriptor>::iterator vecLoc = std::find(bLHalfEdges.begin(), bLHalfEdges.end(), h);
-      if(is_border(h, sm)  && vecLoc == bLHalfEdges.end()) {
-        std::vector<face_descriptor>  patch_facets;
-        std::vector<vertex_descriptor>  patch_vertices;
+    // the holes are independent, each is triangulated from its polyline on its own thread
+    std::vector<std::vector<CGAL::Triple<int, int, int> > > patches(cycles.size());
+    parallelFor(cycles.size(), [&](std::size_t first, std::size_t last) {
+      for (std::size_t k = first; k < last; ++k) {
+        if (k == longest)
+          continue;
+        std::vector<Point_3> polyline;
+        for (std::size_t b = 0; b < cycles[k].size(); ++b)
+          polyline.push_back(sm.point(sm.source(cycles[k][b])));
         try {
-          PMP::triangulate_hole(sm,h,std::back_inserter(patch_facets)
-          ,PMP::parameters::vertex_point_map(get(CGAL::vertex_point, sm)).geom_traits(Kernel()));
+          PMP::triangulate_hole_polyline(polyline, std::back_inserter(patches[k]));
         }
         catch(...)  {
-          continue;
+          patches[k].clear();
+        }
+      }
+    }, 1);
+
+    // the patches are added one after the other, a face with the vertices in the order of the
+    // border cycle closes the hole on its side; a patch which doesn't fit is left to the
+    // fallback below as a whole
+    bool complete = true;
+    for (std::size_t k = 0; k < cycles.size(); ++k) {
+      if (k == longest)
+        continue;
+      if (!patchFits(sm, cycles[k], patches[k])) {
+        complete = false;
+        continue;
+      }
+      std::vector<face_descriptor> added;
+      for (std::size_t p = 0; p < patches[k].size(); ++p) {
+        int v[3] = { patches[k][p].first, patches[k][p].second, patches[k][p].third };
+        std::sort(v, v + 3);
+        face_descriptor fd = sm.add_face(sm.source(cycles[k][v[0]]), sm.source(cycles[k][v[1]]), sm.source(cycles[k][v[2]]));
+        if (fd == Surface_mesh::null_face()) {
+          // not expected after patchFits, the hole is restored before the fallback
+          for (std::size_t a = added.size(); a-- > 0; )
+            CGAL::Euler::remove_face(sm.halfedge(added[a]), sm);
+          complete = false;
+          break;
         }
+        added.push_back(fd);
       }
     }
 
+    // holes the polyline patch did not close, e.g. ones pinched at a vertex, are filled
+    // on the mesh one by one
+    if (!complete) {
+      BOOST_FOREACH(halfedge_descriptor h, halfedges(sm)) {
+        bool isLongest = (std::size_t) h < onLongest.size() && onLongest[(std::size_t) h];
+        if(is_border(h, sm) && !isLongest) {
+          std::vector<face_descriptor>  patch_facets;
+          try {
+            PMP::triangulate_hole(sm,h,std::back_inserter(patch_facets)
+            ,PMP::parameters::vertex_point_map(get(CGAL::vertex_point, sm)).geom_traits(Kernel()));
+          }
+          catch(...)  {
+            continue;
+          }
+        }
+      }
+    }
   }
-  // something is wrong
-  else if(bCounter < bLCounter)  {
-    return false;
-  }
+
+  // the saved order is the one every later stage works in
+  if (Flag.reorder)
+    reorder(sm);
 
   if(!saveMesh(filepath, sm, ", hole closed", LogFile))
     return false;
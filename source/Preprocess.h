@@ -11,6 +11,7 @@
 #define PREPROCESS_H_
 
 #include "include.h"
+#include "Workspace.h"
 
 typedef CGAL::Aff_transformation_3<Kernel> K_AffineTran;
 #include <CGAL/Polygon_mesh_processing/distance.h>
@@ -18,24 +19,59 @@ typedef CGAL::Aff_transformation_3<Kernel> K_AffineTran;
 #include <CGAL/Polygon_mesh_processing/bbox.h>
 #include <CGAL/Polygon_mesh_processing/refine.h>
 #include <CGAL/Polygon_mesh_processing/remesh.h>
+#include <CGAL/Polygon_mesh_processing/connected_components.h>
+#include <CGAL/Polygon_mesh_processing/triangulate_hole.h>
 namespace PMP = CGAL::Polygon_mesh_processing;
+#include <CGAL/boost/graph/Euler_operations.h>
+
+#include <atomic>
+#include <map>
+#include <thread>
 
 
 class Preprocess {
 public:
-  Preprocess(std::stringstream & LogFile, fs::path inputPath, fs::path outputPath);
+  Preprocess(std::stringstream & LogFile, Workspace & WS, fs::path inputPath, fs::path outputPath, flag &Flag);
   virtual ~Preprocess();
   bool slice();
 
 
 private:
+  bool clipNSave(Surface_mesh& sm, const slicePlane& sp, const CGAL::Bbox_3& bbox, fs::path filepath);
   bool saveSlice(fs::path& filepath, Surface_mesh &sm);
   void refineOnly(Surface_mesh &sm);
   bool closeHoles(fs::path& filepath);
+  bool reorder(Surface_mesh &sm);
+  static uint64_t spreadBits(uint64_t x);
+  CGAL::Bbox_3 bbox(const Surface_mesh& sm) const;
+  void keepLargestComponent(Surface_mesh& sm) const;
+  static bool patchFits(const Surface_mesh& sm, const std::vector<halfedge_descriptor>& cycle,
+      const std::vector<CGAL::Triple<int, int, int> >& patch);
+
+  // elements below which a loop over mesh elements isn't worth a thread
+  static const std::size_t grain = 4096;
+
+  // calls fn(first, last) for consecutive chunks of [0, n) of at least grain elements on up to
+  // nThreads threads, ranges too small to pay for a thread stay on the calling one. first / grain
+  // is distinct for every chunk and grows with first, so per chunk results stored at that slot
+  // (n / grain + 1 of them) are merged in the same order on every run
+  template <typename Fn>
+  void parallelFor(std::size_t n, Fn fn, std::size_t grain = Preprocess::grain) const {
+    std::size_t nChunks = std::max<std::size_t>(1, std::min<std::size_t>(nThreads, n / grain));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < nChunks; ++t)
+      threads.push_back(std::thread(fn, n * t / nChunks, n * (t + 1) / nChunks));
+    fn((std::size_t) 0, n / nChunks);
+    for (std::size_t t = 0; t < threads.size(); ++t)
+      threads[t].join();
+  }
 
   fs::path inputPath, outputPath;
   bool bdebug;
   std::stringstream& LogFile;
+  Workspace& WS;  // reusable storage of the current worker
+  flag& Flag; // program flags
+  int nThreads; // threads of the per element loops of one mesh
 };
 
 #endif /* PREPROCESS_H_ */
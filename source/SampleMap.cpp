@@ -0,0 +1,90 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "SampleMap.h"
+
+SampleMap::SampleMap(): im_size(0), nV(0) {
+}
+
+SampleMap::~SampleMap() {
+  // TODO Auto-generated destructor stub
+}
+
+void SampleMap::build(Surface_mesh& Mesh_2D, int im_size) {
+  this->im_size = im_size;
+  nV = Mesh_2D.number_of_vertices();
+  start.assign(im_size * im_size + 1, 0);
+
+  // the faces are covered twice, first counting the samples of each pixel, then filling them
+  // in, which keeps the samples of a pixel together without a list per pixel
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) {
+      for (int p = 0; p < im_size * im_size; ++p)
+        start[p + 1] += start[p];
+      samples.resize(start.back());
+    }
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    float P[2][3];
+    sample s;
+    BOOST_FOREACH(face_descriptor fd, Mesh_2D.faces()) {
+      int vt_count = 0;
+      BOOST_FOREACH(vertex_descriptor vd_2D, vertices_around_face(Mesh_2D.halfedge(fd), Mesh_2D)) {
+        P[0][vt_count] = Mesh_2D.point(vd_2D)[0] * (im_size - 1);
+        P[1][vt_count] = Mesh_2D.point(vd_2D)[1] * (im_size - 1);
+        s.v[vt_count] = (int) vd_2D;
+        vt_count++;
+      }
+      coverFace(P, im_size, [&](int r_idx, int c_idx, const float* c) {
+        int p = r_idx * im_size + c_idx;
+        if (pass == 0) {
+          start[p + 1]++;
+          return;
+        }
+        std::copy(c, c + 3, s.c);
+        samples[fill[p]++] = s;
+      });
+    }
+  }
+}
+
+bool SampleMap::write(fs::path mapFile) const {
+  std::ofstream out(mapFile.string().c_str(), std::ios::binary);
+  if (!out) {
+    std::cerr << "Couldn't open " << mapFile << " to write\n";
+    return false;
+  }
+  header h = { { 'L', 'S', 'S', 'M' }, 1, (uint32_t) im_size, (uint32_t) nV, samples.size() };
+  out.write((const char*) &h, sizeof(h));
+  out.write((const char*) &start[0], start.size() * sizeof(uint32_t));
+  if (!samples.empty())
+    out.write((const char*) &samples[0], samples.size() * sizeof(sample));
+  return (bool) out;
+}
+
+bool SampleMap::read(fs::path mapFile) {
+  std::ifstream in(mapFile.string().c_str(), std::ios::binary);
+  header h;
+  if (!in || !in.read((char*) &h, sizeof(h)) || std::string(h.magic, 4) != "LSSM" || h.version != 1) {
+    std::cerr << "Couldn't read sampling map " << mapFile << "\n";
+    return false;
+  }
+  im_size = h.im_size;
+  nV = h.nV;
+  start.resize(im_size * im_size + 1);
+  samples.resize(h.nSamples);
+  in.read((char*) &start[0], start.size() * sizeof(uint32_t));
+  if (!samples.empty())
+    in.read((char*) &samples[0], samples.size() * sizeof(sample));
+  if (!in || start.back() != samples.size()) {
+    std::cerr << "Sampling map " << mapFile << " is truncated\n";
+    im_size = 0;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef SAMPLEMAP_H_
+#define SAMPLEMAP_H_
+
+#include "include.h"
+#include "GIGenerator.h"
+
+// The samples the scatter sampler takes for a parameterization at one GI size: for every
+// pixel the corners and barycentric coords of each face covering it, stored pixel after pixel
+// with the coverage count of each pixel. Resampling any attribute list from it gives the
+// scatter result in time linear in the pixels and samples, without the parameterized mesh.
+class SampleMap {
+public:
+  SampleMap();
+  virtual ~SampleMap();
+  void build(Surface_mesh& Mesh_2D, int im_size);
+  bool write(fs::path mapFile) const;
+  bool read(fs::path mapFile);
+  int size() const { return im_size; }
+  std::size_t nVertices() const { return nV; }
+  template <typename Generator> void resample(const Generator& generator, cv::Mat* acc, cv::Mat& Mnb) const;
+
+private:
+  struct header {
+    char magic[4];  // LSSM
+    uint32_t version;
+    uint32_t im_size;
+    uint32_t nV;  // vertices of the parameterization, the 3D mesh must match
+    uint64_t nSamples;
+  };
+  struct sample {
+    int32_t v[3]; // corners in the vertex order of the mesh files
+    float c[3]; // barycentric coords of the pixel
+  };
+
+  int im_size;
+  std::size_t nV;
+  std::vector<uint32_t> start;  // offset of the samples of each pixel, im_size*im_size+1 entries
+  std::vector<sample> samples;
+};
+
+template <typename Generator>
+void SampleMap::resample(const Generator& generator, cv::Mat* acc, cv::Mat& Mnb) const {
+  // the 3D mesh vertex with the same index as the 2D one
+  vertex_descriptor vd[3];
+  for (int r_idx = 0; r_idx < im_size; ++r_idx) {
+    for (int c_idx = 0; c_idx < im_size; ++c_idx) {
+      int p = r_idx * im_size + c_idx;
+      for (uint32_t s = start[p]; s < start[p + 1]; ++s) {
+        for (int k = 0; k < 3; ++k)
+          vd[k] = vertex_descriptor(samples[s].v[k]);
+        generator.template sample<true>(vd, samples[s].c, acc, r_idx, c_idx, s == start[p]);
+      }
+      Mnb.at<float>(r_idx, c_idx) += start[p + 1] - start[p];
+    }
+  }
+}
+
+#endif /* SAMPLEMAP_H_ */
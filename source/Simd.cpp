@@ -0,0 +1,202 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Simd.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LSS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+// scalar loops, the tails of the vector kernels and the kernels of other architectures
+void divideCountsTail(float* acc, const float* nb, std::size_t p, std::size_t n) {
+  for (; p < n; ++p)
+    acc[p] = nb[p] > 0 ? acc[p] / nb[p] : 0;
+}
+
+void coverageMasksTail(const float* nb, uint8_t* value, uint8_t* hole, std::size_t p, std::size_t n) {
+  for (; p < n; ++p) {
+    value[p] = nb[p] > 0 ? 255 : 0;
+    hole[p] = 255 - value[p];
+  }
+}
+
+#ifdef LSS_SIMD_X86
+// SSE2 is part of x86-64, these need no target attribute
+void divideCountsSSE2(float* acc, const float* nb, std::size_t n) {
+  const __m128 zero = _mm_setzero_ps();
+  std::size_t p = 0;
+  for (; p + 4 <= n; p += 4) {
+    __m128 c = _mm_loadu_ps(nb + p);
+    __m128 q = _mm_div_ps(_mm_loadu_ps(acc + p), c);
+    // the quotient of an empty pixel is masked out, also when it is inf or nan
+    _mm_storeu_ps(acc + p, _mm_and_ps(q, _mm_cmpgt_ps(c, zero)));
+  }
+  divideCountsTail(acc, nb, p, n);
+}
+
+void coverageMasksSSE2(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128i ones = _mm_set1_epi8(-1);
+  std::size_t p = 0;
+  for (; p + 16 <= n; p += 16) {
+    // 16 compares of all ones or zeros narrowed to 16 bytes of 255 or 0
+    __m128i m0 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(nb + p), zero));
+    __m128i m1 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(nb + p + 4), zero));
+    __m128i m2 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(nb + p + 8), zero));
+    __m128i m3 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(nb + p + 12), zero));
+    __m128i m = _mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3));
+    _mm_storeu_si128((__m128i*) (value + p), m);
+    _mm_storeu_si128((__m128i*) (hole + p), _mm_xor_si128(m, ones));
+  }
+  coverageMasksTail(nb, value, hole, p, n);
+}
+
+__attribute__((target("avx2")))
+void divideCountsAVX2(float* acc, const float* nb, std::size_t n) {
+  const __m256 zero = _mm256_setzero_ps();
+  std::size_t p = 0;
+  for (; p + 8 <= n; p += 8) {
+    __m256 c = _mm256_loadu_ps(nb + p);
+    __m256 q = _mm256_div_ps(_mm256_loadu_ps(acc + p), c);
+    _mm256_storeu_ps(acc + p, _mm256_and_ps(q, _mm256_cmp_ps(c, zero, _CMP_GT_OQ)));
+  }
+  divideCountsTail(acc, nb, p, n);
+}
+
+__attribute__((target("avx2")))
+void coverageMasksAVX2(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256i ones = _mm256_set1_epi8(-1);
+  // the packs work within 128 bit lanes, the permutation restores the pixel order
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  std::size_t p = 0;
+  for (; p + 32 <= n; p += 32) {
+    __m256i m0 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(nb + p), zero, _CMP_GT_OQ));
+    __m256i m1 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(nb + p + 8), zero, _CMP_GT_OQ));
+    __m256i m2 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(nb + p + 16), zero, _CMP_GT_OQ));
+    __m256i m3 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(nb + p + 24), zero, _CMP_GT_OQ));
+    __m256i m = _mm256_packs_epi16(_mm256_packs_epi32(m0, m1), _mm256_packs_epi32(m2, m3));
+    m = _mm256_permutevar8x32_epi32(m, order);
+    _mm256_storeu_si256((__m256i*) (value + p), m);
+    _mm256_storeu_si256((__m256i*) (hole + p), _mm256_xor_si256(m, ones));
+  }
+  coverageMasksTail(nb, value, hole, p, n);
+}
+
+// GCC 12 reports the undefined placeholder operands of the avx512f header intrinsics used by
+// the conversions below as -Wmaybe-uninitialized, a false positive
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+__attribute__((target("avx512f")))
+void divideCountsAVX512(float* acc, const float* nb, std::size_t n) {
+  const __m512 zero = _mm512_setzero_ps();
+  std::size_t p = 0;
+  for (; p + 16 <= n; p += 16) {
+    __m512 c = _mm512_loadu_ps(nb + p);
+    __mmask16 k = _mm512_cmp_ps_mask(c, zero, _CMP_GT_OQ);
+    _mm512_storeu_ps(acc + p, _mm512_maskz_div_ps(k, _mm512_loadu_ps(acc + p), c));
+  }
+  divideCountsTail(acc, nb, p, n);
+}
+
+__attribute__((target("avx512f")))
+void coverageMasksAVX512(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n) {
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512i ones = _mm512_set1_epi32(-1);
+  std::size_t p = 0;
+  for (; p + 16 <= n; p += 16) {
+    __mmask16 k = _mm512_cmp_ps_mask(_mm512_loadu_ps(nb + p), zero, _CMP_GT_OQ);
+    // the truncation of all ones or zeros per pixel gives 255 or 0
+    _mm_storeu_si128((__m128i*) (value + p), _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(k, ones)));
+    _mm_storeu_si128((__m128i*) (hole + p), _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(_mm512_knot(k), ones)));
+  }
+  coverageMasksTail(nb, value, hole, p, n);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+void divideCountsScalar(float* acc, const float* nb, std::size_t n) {
+  divideCountsTail(acc, nb, 0, n);
+}
+
+void coverageMasksScalar(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n) {
+  coverageMasksTail(nb, value, hole, 0, n);
+}
+
+#endif
+}
+
+Simd::level Simd::active() {
+  static const level l = detect();
+  return l;
+}
+
+const char* Simd::name(level l) {
+  static const char* names[] = { "sse2", "avx2", "avx512" };
+  return names[l];
+}
+
+void Simd::divideCounts(float* acc, const float* nb, std::size_t n) {
+  table().divideCounts(acc, nb, n);
+}
+
+void Simd::coverageMasks(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n) {
+  table().coverageMasks(nb, value, hole, n);
+}
+
+
+// private
+Simd::level Simd::detect() {
+  level supported = SSE2;
+#ifdef LSS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    supported = AVX512;
+  else if (__builtin_cpu_supports("avx2"))
+    supported = AVX2;
+#endif
+  const char* env = std::getenv("LSS_SIMD");
+  if (env == NULL || *env == '\0')
+    return supported;
+  for (int l = SSE2; l <= AVX512; ++l) {
+    if (std::strcmp(env, name((level) l)) != 0)
+      continue;
+    if (l > supported) {
+      std::cerr << "LSS_SIMD=" << env << " is not supported by this CPU, using " << name(supported) << "\n";
+      return supported;
+    }
+    return (level) l;
+  }
+  std::cerr << "LSS_SIMD=" << env << " is neither sse2, avx2 nor avx512, using " << name(supported) << "\n";
+  return supported;
+}
+
+const Simd::kernels& Simd::table() {
+#ifdef LSS_SIMD_X86
+  static const kernels variants[] = {
+    { divideCountsSSE2, coverageMasksSSE2 },
+    { divideCountsAVX2, coverageMasksAVX2 },
+    { divideCountsAVX512, coverageMasksAVX512 }
+  };
+  return variants[active()];
+#else
+  static const kernels scalar = { divideCountsScalar, coverageMasksScalar };
+  return scalar;
+#endif
+}
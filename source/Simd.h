@@ -0,0 +1,42 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Whole image kernels of the GI generation in SSE2, AVX2 and AVX-512 variants. The variants are
+// compiled with function target attributes, so the baseline build runs on any x86-64 node, and
+// the widest one the CPU supports is picked on the first call. LSS_SIMD=sse2|avx2|avx512 in the
+// environment forces a level for benchmarking, as far as the CPU supports it.
+class Simd {
+public:
+  enum level { SSE2 = 0, AVX2 = 1, AVX512 = 2 };
+
+  static level active();
+  static const char* name(level l);
+
+  // acc[p] /= nb[p] where nb[p] > 0, 0 elsewhere
+  static void divideCounts(float* acc, const float* nb, std::size_t n);
+  // 255 where nb[p] > 0 and 0 elsewhere into value, the inverse into hole
+  static void coverageMasks(const float* nb, uint8_t* value, uint8_t* hole, std::size_t n);
+
+private:
+  struct kernels {
+    void (*divideCounts)(float*, const float*, std::size_t);
+    void (*coverageMasks)(const float*, uint8_t*, uint8_t*, std::size_t);
+  };
+
+  static level detect();
+  static const kernels& table();
+};
+
+#endif /* SIMD_H_ */
@@ -0,0 +1,274 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Sweep.h"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef CGAL_LINKED_WITH_TBB
+typedef CGAL::Parallel_tag Concurrency_tag;
+#else
+typedef CGAL::Sequential_tag Concurrency_tag;
+#endif
+
+Sweep::Sweep(flag& Flag, const std::vector<fs::path>& items, fs::path outputPath):
+Flag(Flag), items(items), outputPath(outputPath) {
+}
+
+Sweep::~Sweep() {
+  // TODO Auto-generated destructor stub
+}
+
+bool Sweep::run(std::string tablePath) {
+  // a setting which is not swept is taken from the regular flags
+  std::vector<int> iterList = Flag.sweepIter.empty() ? std::vector<int>(1, Flag.sPIterations) : Flag.sweepIter;
+  std::vector<int> sizeList = Flag.sweepSize.empty() ? std::vector<int>(1, Flag.im_size) : Flag.sweepSize;
+  std::vector<double> refineList = Flag.sweepRefine.empty() ? std::vector<double>(1, Flag.refineDensity) : Flag.sweepRefine;
+  std::vector<int> fillList = Flag.sweepFill.empty() ? std::vector<int>(1, Flag.fillIter) : Flag.sweepFill;
+  if (iterList[0] <= 0 || sizeList[0] <= 0) {
+    std::cerr << "Sweep requires --sPI and --m2G or --sweepIter and --sweepSize\n";
+    return false;
+  }
+
+  for (std::size_t a = 0; a < iterList.size(); ++a)
+    for (std::size_t b = 0; b < sizeList.size(); ++b)
+      for (std::size_t c = 0; c < refineList.size(); ++c)
+        for (std::size_t d = 0; d < fillList.size(); ++d) {
+          setting s = { iterList[a], sizeList[b], refineList[c], fillList[d] };
+          std::stringstream name;
+          name << "i" << s.iterations << "_s" << s.im_size << "_r" << s.refineDensity << "_f" << s.fillIter << "/";
+          fs::path dir = outputPath / name.str();
+          std::cout << "Sweep " << name.str() << std::endl;
+
+          result r;
+          r.s = s;
+          if (!runSetting(s, dir, r)) {
+            Log.log(Logger::ERROR, dir.string(), "sweep", 0, "setting did not finish\n");
+            continue;
+          }
+          Logger::metrics kv;
+          Logger::metric(kv, "failed", r.nFailed);
+          Logger::metric(kv, "peakMB", r.peakMB);
+          Logger::metric(kv, "hausdorff", r.hausdorff);
+          Logger::metric(kv, "chamfer", r.chamfer);
+          std::stringstream tmpSS;
+          tmpSS << dir.string() << " : " << r.secPerItem << " sec/item, " << r.peakMB << " MB, chamfer " << r.chamfer << "\n";
+          Log.log(Logger::INFO, dir.string(), "sweep", r.secPerItem * 1000, tmpSS.str(), kv);
+          results.push_back(r);
+        }
+
+  markPareto();
+  return writeTable(tablePath);
+}
+
+
+// private
+bool Sweep::runSetting(const setting& s, fs::path dir, result& r) {
+  // outputs of an earlier sweep would be reused by the stages and spoil the timing
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  // the setting is run in a child so that its peak RSS can be read from wait4
+  std::cout << std::flush;
+  std::cerr << std::flush;
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "Couldn't fork sweep setting\n";
+    return false;
+  }
+  if (pid == 0) {
+    processSetting(s, dir);
+    _exit(0);
+  }
+
+  int status = 0;
+  struct rusage ru;
+  if (wait4(pid, &status, 0, &ru) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    return false;
+  r.peakMB = ru.ru_maxrss / 1024.0;
+
+  fs::ifstream in_fs(dir / "result.txt");
+  int nOk;
+  double sec, sumHausdorff, sumChamfer;
+  if (!(in_fs >> r.nItems >> nOk >> sec >> sumHausdorff >> sumChamfer))
+    return false;
+  r.nFailed = r.nItems - nOk;
+  r.secPerItem = r.nItems ? sec / r.nItems : 0;
+  r.hausdorff = nOk ? sumHausdorff / nOk : std::numeric_limits<double>::infinity();
+  r.chamfer = nOk ? sumChamfer / nOk : std::numeric_limits<double>::infinity();
+  r.pareto = false;
+  return true;
+}
+
+void Sweep::processSetting(const setting& s, fs::path dir) {
+  // runs in the forked child, the logger thread of the parent does not exist here
+  flag F = Flag;
+  F.sPIterations = s.iterations;
+  F.im_size = s.im_size;
+  F.refineDensity = s.refineDensity;
+  F.fillIter = s.fillIter;
+  F.planes.clear(); // the chain reads the slice under the name of the input
+
+  Workspace WS;
+  std::stringstream LogSS;
+  int nOk = 0;
+  double sumHausdorff = 0, sumChamfer = 0;
+  std::chrono::high_resolution_clock::time_point begin_t = std::chrono::high_resolution_clock::now();
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    WS.beginItem();
+    Progress().str(std::string());
+    Progress() << items[i].string() << " : ";
+    LogSS << items[i].string() << " : ";
+    double err[2];
+    if (processItem(items[i], dir, F, WS, err, LogSS)) {
+      ++nOk;
+      sumHausdorff += err[0];
+      sumChamfer += err[1];
+      LogSS << "hausdorff " << err[0] << ", chamfer " << err[1];
+      Progress() << ", chamfer " << err[1];
+    }
+    LogSS << "\n";
+    std::cout << Progress().str() << std::endl;
+  }
+  double sec = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-begin_t).count() / 1000.0;
+
+  fs::ofstream log_fs(dir / "log.txt");
+  log_fs << LogSS.str();
+  fs::ofstream out_fs(dir / "result.txt");
+  out_fs << items.size() << " " << nOk << " " << sec << " " << sumHausdorff << " " << sumChamfer << "\n";
+}
+
+bool Sweep::processItem(const fs::path& item, fs::path dir, flag& F, Workspace& WS, double err[2], std::stringstream& LogSS) {
+  // slice -> sPI -> m2G -> G2o, each stage reads the output of the previous one
+  fs::path sliceDir = dir / "slice/";
+  fs::path remeshDir = dir / "remesh/";
+  fs::create_directories(sliceDir);
+  fs::create_directories(remeshDir);
+
+  Preprocess PP(LogSS, WS, item, sliceDir, F);
+  if (!PP.slice())
+    return false;
+  fs::path sliced = sliceDir / (item.stem().string() + ".off");
+
+  Parameterization PM(LogSS, WS, sliced, dir, F);
+  if (!PM.surfaceParameteriseIterative(F.sPIterations) || !PM.mesh2GI())
+    return false;
+  fs::path flatGI = (dir / sliced.stem()).string() + "_arcSMI_" + std::to_string(F.im_size) + "_" + GIPosition::name() + ".png";
+
+  Parameterization RM(LogSS, WS, flatGI, remeshDir, F);
+  if (!RM.GI2off())
+    return false;
+  fs::path remeshed = (remeshDir / flatGI.stem()).string() + ".off";
+
+  Surface_mesh& ref = WS.acquireMesh(Workspace::MESH_3D);
+  Surface_mesh& rec = WS.acquireMesh(Workspace::MESH_2D);
+  if (!meshLoader(sliced, ref, " sliced mesh", LogSS) || !meshLoader(remeshed, rec, " remeshed pointcloud", LogSS))
+    return false;
+  return reconstructionError(ref, rec, err);
+}
+
+bool Sweep::reconstructionError(Surface_mesh& ref, Surface_mesh& rec, double err[2]) {
+  // the remeshed pointcloud lives in the unit frame of the geometry image (see combineNSave),
+  // the sliced mesh is brought into the same frame from its bounding box
+  CGAL::Bbox_3 bb = PMP::bbox(ref);
+  double scale = std::max(2 * (bb.xmax() - bb.xmin()), std::max(bb.ymax() - bb.ymin(), bb.zmax() - bb.zmin()));
+  if (scale <= 0 || ref.number_of_faces() == 0)
+    return false;
+  std::vector<Point_3> refPts, recPts;
+  BOOST_FOREACH(vertex_descriptor vd, vertices(ref)) {
+    const Point_3& p = ref.point(vd);
+    ref.point(vd) = Point_3((p.x() - bb.xmin()) / scale, (p.y() - bb.ymin()) / scale, (p.z() - bb.zmin()) / scale);
+    refPts.push_back(ref.point(vd));
+  }
+  BOOST_FOREACH(vertex_descriptor vd, vertices(rec))
+    recPts.push_back(rec.point(vd));
+
+  // symmetric Hausdorff distance
+  double toRef = PMP::max_distance_to_triangle_mesh<Concurrency_tag>(recPts, ref);
+  double toRec = PMP::approximate_max_distance_to_point_set(ref, recPts, 1e-3);
+  err[0] = std::max(toRef, toRec);
+
+  // symmetric Chamfer distance: mean distance of the pointcloud to the mesh plus
+  // mean distance of the mesh vertices to the pointcloud, spread over the cores
+  AABB_tree tree(faces(ref).first, faces(ref).second, ref);
+  tree.accelerate_distance_queries();
+  Neighbor_search::Tree kdTree(recPts.begin(), recPts.end());
+  kdTree.build();
+  unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<double> sumToRef(nThreads, 0), sumToRec(nThreads, 0);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < nThreads; ++t)
+    workers.push_back(std::thread([&, t]() {
+      for (std::size_t i = t; i < recPts.size(); i += nThreads)
+        sumToRef[t] += std::sqrt(CGAL::to_double(tree.squared_distance(recPts[i])));
+      for (std::size_t i = t; i < refPts.size(); i += nThreads) {
+        Neighbor_search search(kdTree, refPts[i], 1);
+        sumToRec[t] += std::sqrt(CGAL::to_double(search.begin()->second));
+      }
+    }));
+  for (unsigned t = 0; t < nThreads; ++t)
+    workers[t].join();
+  err[1] = std::accumulate(sumToRef.begin(), sumToRef.end(), 0.0) / recPts.size() +
+      std::accumulate(sumToRec.begin(), sumToRec.end(), 0.0) / refPts.size();
+  return true;
+}
+
+void Sweep::markPareto() {
+  // a setting is on the front if no other setting is at least as good in time, memory and
+  // both errors and better in one of them; settings which lost items are never on the front
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    result& r = results[i];
+    r.pareto = r.nFailed == 0;
+    for (std::size_t j = 0; j < results.size() && r.pareto; ++j) {
+      const result& q = results[j];
+      if (j == i || q.nFailed)
+        continue;
+      bool noWorse = q.secPerItem <= r.secPerItem && q.peakMB <= r.peakMB &&
+          q.hausdorff <= r.hausdorff && q.chamfer <= r.chamfer;
+      bool better = q.secPerItem < r.secPerItem || q.peakMB < r.peakMB ||
+          q.hausdorff < r.hausdorff || q.chamfer < r.chamfer;
+      if (noWorse && better)
+        r.pareto = false;
+    }
+  }
+}
+
+bool Sweep::writeTable(std::string tablePath) {
+  std::ofstream table(tablePath.c_str());
+  if (!table) {
+    std::cerr << "Couldn't open " << tablePath << " to write\n";
+    return false;
+  }
+
+  // cheapest first, with --sweepBar the cheapest setting reaching the bar is marked
+  std::sort(results.begin(), results.end(), [](const result& a, const result& b) { return a.secPerItem < b.secPerItem; });
+  bool chosen = false;
+  std::stringstream tmpSS;
+  tmpSS << "iterations\tim_size\trefine\tfill\titems\tfailed\tsec/item\tpeakMB\thausdorff\tchamfer\tpareto";
+  if (Flag.sweepBar > 0)
+    tmpSS << "\tbar";
+  tmpSS << "\n";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const result& r = results[i];
+    tmpSS << r.s.iterations << "\t" << r.s.im_size << "\t" << r.s.refineDensity << "\t" << r.s.fillIter << "\t"
+        << r.nItems << "\t" << r.nFailed << "\t" << r.secPerItem << "\t" << r.peakMB << "\t"
+        << r.hausdorff << "\t" << r.chamfer << "\t" << (r.pareto ? "*" : "");
+    if (Flag.sweepBar > 0) {
+      bool reached = r.nFailed == 0 && r.chamfer <= Flag.sweepBar;
+      tmpSS << "\t" << (reached ? (chosen ? "ok" : "cheapest") : "");
+      chosen = chosen || reached;
+    }
+    tmpSS << "\n";
+  }
+  table << tmpSS.str();
+  std::cout << tmpSS.str() << "Sweep table written to " << tablePath << std::endl;
+  return true;
+}
@@ -0,0 +1,66 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include "include.h"
+#include "Workspace.h"
+#include "Preprocess.h"
+#include "Parameterization.h"
+
+#include <CGAL/Search_traits_3.h>
+#include <CGAL/Orthogonal_k_neighbor_search.h>
+
+#include <numeric>
+
+typedef CGAL::Orthogonal_k_neighbor_search<CGAL::Search_traits_3<Kernel> > Neighbor_search;
+
+// Runs slice, sPI, m2G and G2o on the list for every combination of the sweep settings and
+// writes a table with the cost (time, peak RSS) and the reconstruction error of each
+// combination, marking the combinations on the Pareto front. Each combination runs in its
+// own forked process so that the peak RSS is that of the combination alone.
+class Sweep {
+public:
+  struct setting {
+    int iterations;
+    int im_size;
+    double refineDensity;
+    int fillIter;
+  };
+  struct result {
+    setting s;
+    int nItems;
+    int nFailed;
+    double secPerItem;
+    double peakMB;
+    double hausdorff; // mean over the items of the symmetric Hausdorff distance
+    double chamfer; // mean over the items of the symmetric Chamfer distance
+    bool pareto;
+  };
+
+  Sweep(flag& Flag, const std::vector<fs::path>& items, fs::path outputPath);
+  virtual ~Sweep();
+  bool run(std::string tablePath);
+
+private:
+  bool runSetting(const setting& s, fs::path dir, result& r);
+  void processSetting(const setting& s, fs::path dir);
+  bool processItem(const fs::path& item, fs::path dir, flag& F, Workspace& WS, double err[2], std::stringstream& LogSS);
+  bool reconstructionError(Surface_mesh& ref, Surface_mesh& rec, double err[2]);
+  void markPareto();
+  bool writeTable(std::string tablePath);
+
+  flag& Flag; // program flags with the sweep settings
+  const std::vector<fs::path>& items; // sample list
+  fs::path outputPath;  // one folder per combination is created in here
+  std::vector<result> results;
+};
+
+#endif /* SWEEP_H_ */
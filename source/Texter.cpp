@@ -8,6 +8,9 @@
  ***************************************************************************************/
 
 #include "Texter.h"
+#include "Pack.h"
+
+#include <set>
 
 Texter::Texter(paths& Paths) {
   this->Paths = &Paths;
@@ -81,16 +84,26 @@ Texter::~Texter() {
 
 void Texter::getFiles(fs::path root, std::vector<fs::path>& ret) {
   // return the path of all files that have the specified extension
-  std::vector<std::string> vStr;
+  // the files of a pack are listed from its index as if they were in its folder
+  std::vector<std::string> vStr, packed;
   for (fs::recursive_directory_iterator it(root); it != fs::recursive_directory_iterator(); ++it) {
     vStr.push_back(it->path().string());
+    if (it->path().filename() == "pack.lssp") {
+      std::shared_ptr<Pack> P = Pack::reader(it->path());
+      std::vector<std::string> names = P ? P->names() : std::vector<std::string>();
+      for (std::size_t k = 0; k < names.size(); ++k)
+        packed.push_back((it->path().parent_path() / names[k]).string());
+    }
   }
+  vStr.insert(vStr.end(), packed.begin(), packed.end());
   std::sort(vStr.begin(), vStr.end(), natural_less<std::string>);
+  vStr.erase(std::unique(vStr.begin(), vStr.end()), vStr.end());
+  std::set<std::string> inPack(packed.begin(), packed.end());
   std::vector<fs::path> v(vStr.begin(), vStr.end());
 
   // filter file list for specified extension and flStr
   for (std::vector<fs::path>::iterator it(v.begin()), it_end(v.end()); it != it_end; ++it) {
-    if (fs::is_regular_file(*it) && it->extension() == Paths->ext) {
+    if ((inPack.count(it->string()) || fs::is_regular_file(*it)) && it->extension() == Paths->ext) {
       if((Paths->flStr != "NULL") && (it->stem().string().find(Paths->flStr)==std::string::npos))
         continue;
       ret.push_back(*it);
@@ -0,0 +1,94 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "UVGrid.h"
+
+UVGrid::UVGrid(): im_size(0), cellSize(1), nCells(0) {
+}
+
+UVGrid::~UVGrid() {
+  // TODO Auto-generated destructor stub
+}
+
+void UVGrid::build(Surface_mesh& Mesh_2D, int im_size, int cellSize) {
+  this->im_size = im_size;
+  this->cellSize = cellSize;
+  this->nCells = (im_size + cellSize - 1) / cellSize;
+
+  // copy the faces into flat arrays, scaled the same way as the scatter sampler
+  P.clear();
+  F.clear();
+  P.reserve(6 * Mesh_2D.number_of_faces());
+  F.reserve(3 * Mesh_2D.number_of_faces());
+  BOOST_FOREACH(face_descriptor fd, Mesh_2D.faces()) {
+    int vt_count = 0;
+    BOOST_FOREACH(vertex_descriptor vd, vertices_around_face(Mesh_2D.halfedge(fd), Mesh_2D)) {
+      if (vt_count++ == 3)
+        break;
+      P.push_back(Mesh_2D.point(vd)[0] * (im_size - 1));
+      P.push_back(Mesh_2D.point(vd)[1] * (im_size - 1));
+      F.push_back(vd);
+    }
+  }
+  int nFaces = F.size() / 3;
+
+  // two passes over the face bounding boxes: count per cell, then fill
+  cellStart.assign(nCells * nCells + 1, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<int> fill;
+    if (pass == 1) {
+      for (int k = 0; k < nCells * nCells; ++k)
+        cellStart[k + 1] += cellStart[k];
+      cellFaces.resize(cellStart[nCells * nCells]);
+      fill.assign(cellStart.begin(), cellStart.end() - 1);
+    }
+    for (int f = 0; f < nFaces; ++f) {
+      const float* p = &P[6 * f];
+      int r0 = std::max(0, (int) std::floor(std::min(std::min(p[0], p[2]), p[4])) / cellSize);
+      int c0 = std::max(0, (int) std::floor(std::min(std::min(p[1], p[3]), p[5])) / cellSize);
+      int r1 = std::min(nCells - 1, (int) std::ceil(std::max(std::max(p[0], p[2]), p[4])) / cellSize);
+      int c1 = std::min(nCells - 1, (int) std::ceil(std::max(std::max(p[1], p[3]), p[5])) / cellSize);
+      for (int r = r0; r <= r1; ++r)
+        for (int c = c0; c <= c1; ++c) {
+          if (pass == 0)
+            cellStart[r * nCells + c + 1]++;
+          else
+            cellFaces[fill[r * nCells + c]++] = f;
+        }
+    }
+  }
+}
+
+bool UVGrid::locate(int r_idx, int c_idx, int& f_idx, float c[3]) const {
+  // faces are tested in face order, so the first face containing the pixel wins
+  // which makes the result independent of how the pixels are distributed over threads
+  int cell = (r_idx / cellSize) * nCells + (c_idx / cellSize);
+  for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+    const float* p = &P[6 * cellFaces[k]];
+    float e1r = p[2] - p[0], e1c = p[3] - p[1];
+    float e2r = p[4] - p[0], e2c = p[5] - p[1];
+    float det = e1r * e2c - e2r * e1c;
+    if (det == 0)
+      continue;
+    float dr = r_idx - p[0], dc = c_idx - p[1];
+    c[1] = (dr * e2c - e2r * dc) / det;
+    c[2] = (e1r * dc - dr * e1c) / det;
+    c[0] = 1 - c[1] - c[2];
+    // same cutoff as the scatter sampler in mesh2GI
+    if (c[0] >= -0.000022204 && c[1] >= -0.000022204 && c[2] >= -0.000022204) {
+      f_idx = cellFaces[k];
+      return true;
+    }
+  }
+  return false;
+}
+
+const vertex_descriptor* UVGrid::faceVertices(int f_idx) const {
+  return &F[3 * f_idx];
+}
@@ -0,0 +1,36 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef UVGRID_H_
+#define UVGRID_H_
+
+#include "include.h"
+
+// Uniform grid over the pixel space of a geometry image which buckets the faces of the
+// parameterized mesh, so that the face containing a pixel can be found without
+// visiting the bounding box of every face
+class UVGrid {
+public:
+  UVGrid();
+  virtual ~UVGrid();
+  void build(Surface_mesh& Mesh_2D, int im_size, int cellSize=4);
+  bool locate(int r_idx, int c_idx, int& f_idx, float c[3]) const;
+  const vertex_descriptor* faceVertices(int f_idx) const;
+
+private:
+  int im_size;
+  int cellSize;
+  int nCells; // number of cells along each side
+  std::vector<float> P; // pixel space coords of the face corners, 6 per face
+  std::vector<vertex_descriptor> F; // corners of each face, 3 per face
+  std::vector<int> cellStart; // offset of each cell into cellFaces, nCells*nCells+1 entries
+  std::vector<int> cellFaces; // face indices bucketed per cell, in face order
+};
+
+#endif /* UVGRID_H_ */
@@ -0,0 +1,110 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Watcher.h"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+Watcher::Watcher(fs::path root, std::string ext, std::string flStr, int debounceMs):
+  root(root), ext(ext), flStr(flStr), debounceMs(debounceMs), fd(-1) {
+}
+
+Watcher::~Watcher() {
+  if (fd >= 0)
+    close(fd);
+}
+
+bool Watcher::start() {
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << "Couldn't start watching " << root << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+  if (!fs::is_directory(root)) {
+    std::cerr << "Couldn't watch " << root << ", not a folder\n";
+    return false;
+  }
+  addTree(root, false);
+  return true;
+}
+
+void Watcher::wait(std::vector<fs::path>& ready, int timeoutMs) {
+  ready.clear();
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  if (poll(&pfd, 1, timeoutMs) > 0) {
+    alignas(struct inotify_event) char buf[64 * 1024];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      for (char* p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event*) p)->len) {
+        const struct inotify_event* ev = (const struct inotify_event*) p;
+        std::map<int, fs::path>::iterator dir = dirs.find(ev->wd);
+        if (ev->mask & IN_IGNORED) {
+          if (dir != dirs.end())
+            dirs.erase(dir);
+          continue;
+        }
+        if (dir == dirs.end() || ev->len == 0)
+          continue;
+        fs::path path = dir->second / ev->name;
+        if (ev->mask & IN_ISDIR) {
+          // files may already be in a folder moved or copied in before it is watched
+          if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+            addTree(path, true);
+          continue;
+        }
+        if (!listed(path))
+          continue;
+        pending& P = files[path];
+        P.last = now;
+        P.closed = (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0;
+      }
+    }
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  for (std::map<fs::path, pending>::iterator it = files.begin(); it != files.end();) {
+    if (it->second.closed && now - it->second.last >= std::chrono::milliseconds(debounceMs)) {
+      ready.push_back(it->first);
+      files.erase(it++);
+    }
+    else
+      ++it;
+  }
+}
+
+
+// private
+void Watcher::addTree(fs::path dir, bool reportFiles) {
+  int wd = inotify_add_watch(fd, dir.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE | IN_ONLYDIR);
+  if (wd < 0) {
+    std::cerr << "Couldn't watch " << dir << ": " << std::strerror(errno) << "\n";
+    return;
+  }
+  dirs[wd] = dir;
+  boost::system::error_code ec;
+  for (fs::directory_iterator it(dir, ec); !ec && it != fs::directory_iterator(); ++it) {
+    if (fs::is_directory(it->path()))
+      addTree(it->path(), reportFiles);
+    else if (reportFiles && listed(it->path())) {
+      pending& P = files[it->path()];
+      P.last = std::chrono::steady_clock::now();
+      P.closed = true;
+    }
+  }
+}
+
+bool Watcher::listed(const fs::path& file) const {
+  // the filter of Texter::getFiles
+  if (file.extension() != ext)
+    return false;
+  return flStr == "NULL" || file.stem().string().find(flStr) != std::string::npos;
+}
@@ -0,0 +1,47 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef WATCHER_H_
+#define WATCHER_H_
+
+#include "include.h"
+
+#include <chrono>
+#include <map>
+
+// Reports the files with the listed extension and flStr which are written to or moved into a
+// folder tree, using inotify. The tree is walked once when the watch starts; folders created
+// later are watched as they appear. A file is reported once it was closed after writing (or
+// moved in) and has seen no further event for the debounce time, so partial writes are not
+// picked up. Files present before the watch started are not reported.
+class Watcher {
+public:
+  Watcher(fs::path root, std::string ext, std::string flStr, int debounceMs);
+  virtual ~Watcher();
+  bool start();
+  void wait(std::vector<fs::path>& ready, int timeoutMs);
+
+private:
+  struct pending {
+    std::chrono::steady_clock::time_point last;  // time of the last event
+    bool closed;  // the last write was closed or the file was moved in
+  };
+
+  void addTree(fs::path dir, bool reportFiles);
+  bool listed(const fs::path& file) const;
+
+  fs::path root;
+  std::string ext, flStr;
+  int debounceMs;
+  int fd; // inotify instance
+  std::map<int, fs::path> dirs; // watch descriptor -> folder
+  std::map<fs::path, pending> files;  // files with events not yet reported
+};
+
+#endif /* WATCHER_H_ */
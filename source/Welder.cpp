@@ -0,0 +1,53 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Welder.h"
+
+Welder::Welder(double tol): tol(tol), tol2(tol * tol) {
+}
+
+Welder::~Welder() {
+  // TODO Auto-generated destructor stub
+}
+
+int Welder::insert(const Point_3& p) {
+  long long ix = (long long) std::floor(p.x() / tol);
+  long long iy = (long long) std::floor(p.y() / tol);
+  long long iz = (long long) std::floor(p.z() / tol);
+
+  // return the first representative within the tolerance in the surrounding cells
+  for (long long dx = -1; dx <= 1; ++dx)
+    for (long long dy = -1; dy <= 1; ++dy)
+      for (long long dz = -1; dz <= 1; ++dz) {
+        std::unordered_map<long long, std::vector<int> >::const_iterator it = cells.find(cellKey(ix + dx, iy + dy, iz + dz));
+        if (it == cells.end())
+          continue;
+        for (std::size_t k = 0; k < it->second.size(); ++k) {
+          if (CGAL::to_double(CGAL::squared_distance(reps[it->second[k]], p)) <= tol2)
+            return it->second[k];
+        }
+      }
+
+  cells[cellKey(ix, iy, iz)].push_back(reps.size());
+  reps.push_back(p);
+  return reps.size() - 1;
+}
+
+void Welder::clear() {
+  cells.clear();
+  reps.clear();
+}
+
+
+// private
+long long Welder::cellKey(long long ix, long long iy, long long iz) const {
+  // 21 bits per axis, enough for 2 million cells along each side
+  const long long mask = (1LL << 21) - 1;
+  return ((ix & mask) << 42) | ((iy & mask) << 21) | (iz & mask);
+}
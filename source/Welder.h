@@ -0,0 +1,38 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef WELDER_H_
+#define WELDER_H_
+
+#include "include.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+// Merges points closer than a tolerance into one representative. Points are bucketed in a
+// spatial hash with cells of the size of the tolerance, so a point is only compared with
+// the representatives of the 27 cells around it and welding a point set is linear in time.
+class Welder {
+public:
+  Welder(double tol);
+  virtual ~Welder();
+  int insert(const Point_3& p);
+  const std::vector<Point_3>& points() const { return reps; }
+  void clear();
+
+private:
+  long long cellKey(long long ix, long long iy, long long iz) const;
+
+  double tol;
+  double tol2;  // squared tolerance
+  std::unordered_map<long long, std::vector<int> > cells; // representatives per cell
+  std::vector<Point_3> reps;  // welded points in order of insertion
+};
+
+#endif /* WELDER_H_ */
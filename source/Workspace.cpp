@@ -0,0 +1,64 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Workspace.h"
+
+Workspace::Workspace(): copies(1), prefetched(false) {
+}
+
+Workspace::~Workspace() {
+  // TODO Auto-generated destructor stub
+}
+
+void Workspace::beginItem(int copies) {
+  // only the logical size is reset, capacity is kept for the next file
+  this->copies = copies;
+  vds.clear();
+  if (prefetched) {
+    prefetchedMesh.clear();
+    prefetched = false;
+  }
+}
+
+Surface_mesh& Workspace::acquireMesh(int slot) {
+  // the OFF reader sizes the element arrays from the header in one go,
+  // clearing here keeps a slot from accumulating the elements of previous files
+  mesh[slot].clear();
+  return mesh[slot];
+}
+
+void Workspace::setPrefetched(fs::path inputPath, Surface_mesh& sm) {
+  prefetchedPath = inputPath;
+  prefetchedMesh = std::move(sm);
+  prefetched = true;
+}
+
+bool Workspace::loadInput(fs::path inputPath, Surface_mesh& sm, std::string fileDesc, std::stringstream& LogFile,
+    bool bdebug) {
+  // a copy of the prefetched mesh is taken as more than one stage may read the same input
+  if (prefetched && prefetchedPath == inputPath) {
+    sm = prefetchedMesh;
+    if (bdebug)
+      Progress() << "Prefetched Mesh " << inputPath << " has " << sm.number_of_vertices() << " Vertices ";
+    return true;
+  }
+  return meshLoader(inputPath, sm, fileDesc, LogFile, bdebug);
+}
+
+void Workspace::acquireGI(int im_size, int nChannels) {
+  // create() is a no-op when size and type are unchanged, so only zeroing is done per file
+  if ((int) GI.size() < nChannels)
+    GI.resize(nChannels);
+  for (int ch = 0; ch < nChannels; ++ch) {
+    GI[ch].create(im_size, im_size, CV_32FC1);
+    GI[ch].setTo(0);
+  }
+  Mnb.create(im_size, im_size, CV_32FC1);
+  Mnb.setTo(0);
+}
@@ -0,0 +1,54 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef WORKSPACE_H_
+#define WORKSPACE_H_
+
+#include "include.h"
+#include "UVGrid.h"
+#include "SampleMap.h"
+#include "GIGenerator.h"
+#include "GIStats.h"
+
+// Storage owned by one worker of the batch loop and reused for every file it processes.
+// Buffers are cleared and resized for every file; the vectors and matrices keep their
+// allocation when the file fits into it, so a list of similar sized files mostly reuses
+// memory, while a file of another size allocates again.
+class Workspace {
+public:
+  Workspace();
+  virtual ~Workspace();
+  void beginItem(int copies=1);
+  Surface_mesh& acquireMesh(int slot);
+  void acquireGI(int im_size, int nChannels);
+  void setPrefetched(fs::path inputPath, Surface_mesh& sm);
+  bool loadInput(fs::path inputPath, Surface_mesh& sm, std::string fileDesc, std::stringstream& LogFile, bool bdebug=false);
+
+  enum { MESH_3D = 0, MESH_2D = 1, MESH_TMP = 2, NB_MESH = 3 };
+
+  std::vector<vertex_descriptor> vds; // vertex descriptors of the 3D mesh
+  std::vector<cv::Mat> GI; // per channel accumulation buffers of all sampled attributes
+  std::vector<GIChannels> layout; // attributes held in GI
+  cv::Mat Mnb;  // number of samples accumulated per pixel
+  cv::Mat maskValue, maskNaN;  // coverage masks derived from Mnb
+  cv::Mat filterTmp;  // scratch for hole filling of the GI channels
+  cv::Mat M, MM;  // float and 8 bit 3 channel images written by combineNSave
+  UVGrid grid;  // face index of the parameterization used by the gather sampler
+  SampleMap smap;  // per pixel samples of the parameterization, with --sampleMap
+  GIStats stats;  // statistics of the GIs written by this worker, with --giStats
+  int copies;  // inputs the current file stands for, its duplicates included with --dedup
+
+private:
+  Surface_mesh mesh[NB_MESH];
+  bool prefetched;  // input mesh of the current file was already parsed by the Prefetcher
+  fs::path prefetchedPath;
+  Surface_mesh prefetchedMesh;
+};
+
+#endif /* WORKSPACE_H_ */
@@ -8,11 +8,21 @@
  ***************************************************************************************/
 
 #include "include.h"
+#include "Pack.h"
 
 bool outfileExists(fs::path outFilePath, const int size, std::string printDesc) {
+  // outputs written into a pack are looked up in its index only, the folder is not touched
+  std::shared_ptr<Pack> P = Pack::writer(outFilePath);
+  if (P) {
+    if (P->has(outFilePath.filename().string(), size)) {
+      Progress() << printDesc;
+      return true;
+    }
+    return false;
+  }
   if (fs::exists(outFilePath)) {
     if (fs::file_size(outFilePath) > size) {
-      std::cout << printDesc << std::flush;
+      Progress() << printDesc;
       return true;
     } else
       return false;
@@ -21,6 +31,9 @@ bool outfileExists(fs::path outFilePath, const int size, std::string printDesc)
 }
 
 bool infileExists(fs::path inFilePath, const int size, std::string errDesc, std::stringstream& LogFile) {
+  std::shared_ptr<Pack> P = Pack::reader(inFilePath);
+  if (P && P->has(inFilePath.filename().string(), size))
+    return true;
   if (fs::exists(inFilePath)) {
     //check for size of file
     if (fs::file_size(inFilePath) <= size) {
@@ -39,9 +52,16 @@ bool infileExists(fs::path inFilePath, const int size, std::string errDesc, std:
 
 bool meshLoader(fs::path meshFile, Surface_mesh& loadedMesh, std::string fileDesc, std::stringstream& LogFile,
     bool bdebug) {
-  // check if the file exists
-  if (fs::exists(meshFile) && fs::is_regular_file(meshFile)) {
-    fs::ifstream in_fs(meshFile);
+  // a packed file is parsed from memory, otherwise check if the file exists
+  std::string bytes;
+  std::shared_ptr<Pack> P = Pack::reader(meshFile);
+  std::unique_ptr<std::istream> in;
+  if (P && P->get(meshFile.filename().string(), bytes))
+    in.reset(new std::istringstream(bytes));
+  else if (fs::exists(meshFile) && fs::is_regular_file(meshFile))
+    in.reset(new fs::ifstream(meshFile));
+  if (in) {
+    std::istream& in_fs = *in;
     if (!in_fs) {
       std::cerr << "\t Unable to create fs for " << fileDesc << std::endl;
       LogFile << "Unable to create fs for " << fileDesc << "\n";
@@ -66,10 +86,8 @@ bool meshLoader(fs::path meshFile, Surface_mesh& loadedMesh, std::string fileDes
       return false;
     } else {
       if (bdebug)
-        std::cout << "Loaded Mesh " << meshFile << " has " << loadedMesh.number_of_vertices() << " Vertices "
-        << std::flush;
+        Progress() << "Loaded Mesh " << meshFile << " has " << loadedMesh.number_of_vertices() << " Vertices ";
     }
-    in_fs.close();
     return true;
   } else {
     std::cerr << "\t" << fileDesc << "doesn't exists\n";
@@ -95,30 +113,74 @@ bool MLS(fs::path inputPath,fs::path outputPath, std::string mlxScript, std::str
   return true;
 }
 
-int Ceil(cv::Mat A) {
-  int tmp = ceil(A.at<float>(0, 0));
-  for (int i = 1; i < A.cols; ++i) {
-    tmp = ceil(A.at<float>(0, i)) > tmp ? ceil(A.at<float>(0, i)) : tmp;
+bool saveMesh(fs::path meshFile, Surface_mesh& sm, std::string fileDesc, std::stringstream& LogFile)  {
+  if (Pack::writer(meshFile)) {
+    std::ostringstream out_ss;
+    out_ss << sm;
+    if (!writeFile(meshFile, out_ss.str(), LogFile))
+      return false;
+    Progress() << fileDesc;
+    return true;
   }
-  return tmp;
+  fs::ofstream out_fs(meshFile);
+  out_fs << sm;
+  out_fs.close();
+  Progress() << fileDesc;
+  return true;
 }
 
-int Floor(cv::Mat A) {
-  int tmp = floor(A.at<float>(0, 0));
-  for (int i = 1; i < A.cols; ++i) {
-    tmp = floor(A.at<float>(0, i)) < tmp ? floor(A.at<float>(0, i)) : tmp;
+bool writeFile(fs::path file, const std::string& bytes, std::stringstream& LogFile) {
+  // into the pack of the folder when packing, otherwise to the file
+  std::shared_ptr<Pack> P = Pack::writer(file);
+  if (P) {
+    if (!P->put(file.filename().string(), bytes)) {
+      LogFile << "Couldn't write " << file << " to the pack\n";
+      return false;
+    }
+    return true;
   }
-  return tmp;
+  std::ofstream out(file.string().c_str(), std::ios::binary);
+  if (!out || !out.write(bytes.data(), bytes.size())) {
+    std::cerr << "Could not open " << file << " to write\n";
+    LogFile << "Could not open " << file << " to write\n";
+    return false;
+  }
+  return true;
 }
 
-bool saveMesh(fs::path meshFile, Surface_mesh& sm, std::string fileDesc, std::stringstream& LogFile)  {
-  fs::ofstream out_fs(meshFile);
-  out_fs << sm;
-  out_fs.close();
-  std::cout << fileDesc << std::flush;
+bool readFile(fs::path file, std::string& bytes) {
+  // from the pack of the folder when it holds the file, otherwise from the file
+  std::shared_ptr<Pack> P = Pack::reader(file);
+  if (P && P->get(file.filename().string(), bytes))
+    return true;
+  std::ifstream in(file.string().c_str(), std::ios::binary);
+  if (!in)
+    return false;
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  bytes = ss.str();
   return true;
 }
 
+cv::Mat readImage(fs::path file, int flags) {
+  std::string bytes;
+  std::shared_ptr<Pack> P = Pack::reader(file);
+  if (P && P->get(file.filename().string(), bytes))
+    return cv::imdecode(cv::Mat(1, (int) bytes.size(), CV_8U, &bytes[0]), flags);
+  return cv::imread(file.string(), flags);
+}
+
+bool writeImage(fs::path file, const cv::Mat& img, const std::vector<int>& params, std::stringstream& LogFile) {
+  if (!Pack::writer(file))
+    return cv::imwrite(file.string(), img, params);
+  std::vector<uchar> buf;
+  if (!cv::imencode(file.extension().string(), img, buf, params)) {
+    LogFile << "Couldn't encode " << file << "\n";
+    return false;
+  }
+  return writeFile(file, std::string(buf.begin(), buf.end()), LogFile);
+}
+
 std::vector<std::string> splitString(std::string str, std::string delimiters) {
   std::vector<std::string> parts;
   boost::split(parts, str, boost::is_any_of(delimiters));
@@ -14,6 +14,7 @@
 #include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
@@ -32,6 +33,8 @@
 #include <sys/stat.h>
 #include <vector>
 
+#include "Logger.h"
+
 // Boost includes
 #include <boost/filesystem.hpp>
 namespace fs = ::boost::filesystem;
@@ -43,17 +46,32 @@ namespace fs = ::boost::filesystem;
 // Kernels
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Surface_mesh.h>
-typedef CGAL::Simple_cartesian<double> Kernel;
-typedef Kernel::Point_2 Point_2;
-typedef Kernel::Point_3 Point_3;
-typedef Kernel::Plane_3 K_Plane_3;
-typedef CGAL::Surface_mesh<Point_3> Surface_mesh;
+// mesh types for a scalar type, the build selects double (default) or float with LSS_FLOAT_KERNEL
+template<typename FT>
+struct MeshTypes {
+  typedef CGAL::Simple_cartesian<FT> Kernel;
+  typedef typename Kernel::Point_2 Point_2;
+  typedef typename Kernel::Point_3 Point_3;
+  typedef typename Kernel::Plane_3 Plane_3;
+  typedef CGAL::Surface_mesh<Point_3> Surface_mesh;
+};
+#ifdef LSS_FLOAT_KERNEL
+typedef float Scalar;
+#else
+typedef double Scalar;
+#endif
+typedef MeshTypes<Scalar>::Kernel Kernel;
+typedef MeshTypes<Scalar>::Point_2 Point_2;
+typedef MeshTypes<Scalar>::Point_3 Point_3;
+typedef MeshTypes<Scalar>::Plane_3 K_Plane_3;
+typedef MeshTypes<Scalar>::Surface_mesh Surface_mesh;
 typedef boost::graph_traits<Surface_mesh>::vertex_descriptor vertex_descriptor;
 typedef boost::graph_traits<Surface_mesh>::edge_descriptor edge_descriptor;
 typedef boost::graph_traits<Surface_mesh>::halfedge_descriptor halfedge_descriptor;
 typedef boost::graph_traits<Surface_mesh>::face_descriptor face_descriptor;
 typedef boost::graph_traits<Surface_mesh>::vertex_iterator vertex_iterator;
 typedef Surface_mesh::Property_map<vertex_descriptor, int> SM_vimap;
+typedef Surface_mesh::Property_map<vertex_descriptor, Point_2> SM_uvmap;
 
 // openCV Includes
 #include <opencv2/opencv.hpp>
@@ -67,23 +85,71 @@ struct paths  {
   std::string flStr;  // file string requried for selective listing of files
 };
 
+struct slicePlane {
+  double n[3];  // unit normal pointing into the kept half
+  double offset;  // signed distance of the plane from the bounding box center along the given normal
+  std::string tag;  // appended to the file name of the slice
+};
+
 struct flag {
+  std::string watch;  // folder below DBPath watched for new input files, empty for the list file
+  int watchDebounceMs;  // time in ms a new file must stay unchanged before it is processed
+  double dedup; // process inputs of the same geometry signature once and link the outputs, 0 disables
   bool slice; // slice input mesh
+  bool reorder; // with slice, store the slice compacted and in Morton order
+  std::vector<slicePlane> planes; // with slice, clip planes of one load, empty for the x-midplane keeping +x
   bool sPI; // iterative surface parameterization
   bool m2G; // parameterized mesh to geometry image
   bool G2o; // Geometry image to remesh point cloud
+  double weld;  // with G2o, write a triangle mesh with vertices closer than weld merged, 0 for the point cloud
+  bool mirror;  // with G2o, also add the mirror image across the slice plane to the triangle mesh
   bool useNormal; // use normals for geometry image or remesh generation
+  bool curvGI; // also write a mean curvature GI
+  bool colorGI; // also write a vertex color GI, requires a COFF input
+  bool labelGI; // also write a segmentation label GI from a .seg file next to the input
+  bool maskGI;  // also write the coverage mask of the geometry image
+  bool maskNormal;  // also write the normal consistency mask of the normal geometry image
+  bool gather;  // sample geometry image per pixel from a UV grid index instead of per face
+  bool gatherCheck; // also run the per face sampler and log the difference to the gathered samples
+  bool sampleMap; // save the per pixel samples of the parameterization and resample from them when present
+  bool vertexTable; // with m2G, write the pixel coordinates of every vertex of the slice
+  std::string applyGI;  // folder of predicted position GIs applied to the slices through their vertex tables, empty for none
+  int stream; // faces per chunk of the streamed rasterization of a packed mesh, 0 rasterizes the loaded meshes
   int sPIterations; // maximum number of iterations of surface parameterization
+  std::string param;  // parameterizer of sPI: authalic (iterative), fast (discrete conformal) or multilevel
+  int mlMinVertices;  // vertices of the coarsest level of the multilevel parameterization
+  int mlIter; // reweighted solves per finer level of the multilevel parameterization
   int im_size;  // size of geometry image
+  double refineDensity; // density control factor of the refinement while slicing
+  int fillIter; // number of filter iterations filling the holes of the geometry image
+  int prefetch; // number of input meshes parsed ahead on a loader thread, 0 disables prefetching
+  int prefetchMB; // memory cap in MB for the meshes parsed ahead
+  bool jsonl; // additionally write the report log as JSON lines
+  int progressMs; // minimum time in ms between two progress lines on the console
+  bool pack; // write the outputs into the append-only pack of the output folder instead of single files
+  bool isolate; // run the items in forked workers with a watchdog
+  int isolateBatch; // number of items processed by one worker
+  int timeout;  // wall clock limit in seconds per stage of an isolated item, 0 for none
+  int memMB;  // address space limit in MB of an isolated worker, 0 for none
+  std::string giStats;  // file collecting per pixel statistics of the written GIs, empty for none
+  std::vector<std::string> mergeStats;  // statistics files of other runs merged into giStats
+  bool sweep; // run slice, sPI, m2G and G2o for every combination of the sweep settings
+  std::vector<int> sweepIter; // sPI iterations of the sweep
+  std::vector<int> sweepSize; // geometry image sizes of the sweep
+  std::vector<double> sweepRefine;  // refinement density control factors of the sweep
+  std::vector<int> sweepFill; // hole filling iterations of the sweep
+  double sweepBar;  // Chamfer distance a setting must reach to be accepted, 0 for none
 };
 
 bool outfileExists(fs::path outFilePath, const int size, std::string printDesc);
 bool infileExists(fs::path inFilePath, const int size, std::string errDesc, std::stringstream& LogFile);
 bool meshLoader(fs::path meshFile, Surface_mesh& loadedMesh, std::string fileDesc, std::stringstream& LogFile, bool bdebug=false);
 bool MLS(fs::path inputPath,fs::path outputPath, std::string mlxScript, std::string desc, std::stringstream& LogFile, std::string option="NULL");
-int Ceil(cv::Mat A);
-int Floor(cv::Mat A);
 bool saveMesh(fs::path meshFile, Surface_mesh& sm, std::string fileDesc, std::stringstream& LogFile);
+bool writeFile(fs::path file, const std::string& bytes, std::stringstream& LogFile);
+bool readFile(fs::path file, std::string& bytes);
+cv::Mat readImage(fs::path file, int flags);
+bool writeImage(fs::path file, const cv::Mat& img, const std::vector<int>& params, std::stringstream& LogFile);
 std::vector<std::string> splitString(std::string str, std::string delimiters);
 
 #endif /* INCLUDE_H_ */
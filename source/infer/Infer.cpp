@@ -0,0 +1,207 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+// RGB image -> GI -> mesh in one process: the exported TFLite model predicts the GI of a
+// batch of images, which is remeshed in memory by Parameterization::GI2off
+
+#include "include.h"
+#include "Texter.h"
+#include "Workspace.h"
+#include "Parameterization.h"
+#include "Predictor.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+flag Flag;
+paths Paths;
+Logger Log; // report log
+
+// per stage time summed over the workers
+struct latency {
+  double load, infer, remesh;
+  int nImages, nBatches, nFailed;
+};
+
+bool getFlags(char * argv[], int argc, fs::path& outPath, int& batchSize, int& nWorkers, int& nThreads);
+
+int main(int argc, char * argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: ./Infer <model.tflite> <list.txt> [--out <folder>] [--batch <n>] [--workers <n>] [--threads <n>] [--weld <tol>] [--mirror]\n";
+    return -1;
+  }
+  fs::path modelPath = argv[1];
+  Paths.listFilePath = argv[2];
+  Paths.DBPath = Paths.listFilePath.parent_path();
+  fs::path outPath;
+  int batchSize = 8;
+  int nWorkers = 1;
+  int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  if (!getFlags(argv, argc, outPath, batchSize, nWorkers, nThreads))
+    return -1;
+
+  Texter Tx(Paths);
+  if (!Tx.listFilesFromFile())
+    return -1;
+  if (!outPath.empty())
+    fs::create_directories(outPath);
+
+  std::string logFilePath = (Paths.DBPath / ("Report_" + Paths.listFilePath.stem().string() + "_infer.txt")).string();
+  if (!Log.open(logFilePath, "", 1000)) {
+    std::cerr << "    Couldn't open LogFile to write\n";
+    return -1;
+  }
+
+  std::unique_ptr<tflite::FlatBufferModel> model = tflite::FlatBufferModel::BuildFromFile(modelPath.string().c_str());
+  if (!model) {
+    std::cerr << "Couldn't load model " << modelPath << "\n";
+    return -1;
+  }
+
+  // each worker owns an interpreter and takes the next batch of the list, the interpreter
+  // threads of all workers share the cores
+  std::atomic<int> nextBatch(0);
+  int nBatches = (Paths.modelFilePathList.size() + batchSize - 1) / batchSize;
+  latency total = { 0, 0, 0, 0, 0, 0 };
+  std::mutex totalMutex;
+  std::atomic<bool> failedInit(false);  // set by a worker without interpreter, the others stop after their batch
+  std::chrono::high_resolution_clock::time_point begin_main = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> workers;
+  for (int w = 0; w < nWorkers; ++w) {
+    workers.push_back(std::thread([&]() {
+      Predictor P(*model, batchSize, std::max(1, nThreads / nWorkers));
+      if (!P.ok()) {
+        failedInit = true;
+        return;
+      }
+      Workspace WS;
+      std::vector<cv::Mat> rgb, gi;
+      std::vector<fs::path> batch;
+      for (int b = nextBatch++; b < nBatches && !failedInit; b = nextBatch++) {
+        latency own = { 0, 0, 0, 0, 1, 0 };
+        std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+
+        // load
+        batch.clear();
+        rgb.clear();
+        for (int i = b * batchSize; i < std::min((int) Paths.modelFilePathList.size(), (b + 1) * batchSize); ++i) {
+          cv::Mat img;
+          if (P.preprocess(Paths.modelFilePathList[i], img)) {
+            batch.push_back(Paths.modelFilePathList[i]);
+            rgb.push_back(img);
+          }
+          else {
+            Log.log(Logger::ERROR, Paths.modelFilePathList[i].string(), "load", 0, "Unable to read image\n");
+            ++own.nFailed;
+          }
+        }
+        std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+
+        // infer
+        bool inferred = !rgb.empty() && P.predict(rgb, gi);
+        std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+        if (!inferred)
+          own.nFailed += rgb.size();
+
+        // remesh, postprocessed as in python/experiment_test.py
+        for (std::size_t k = 0; inferred && k < gi.size(); ++k) {
+          std::stringstream LogSS;
+          Progress().str(std::string());
+          // scipy's median_filter mirrors the border without repeating the edge pixel, medianBlur
+          // would replicate it, so the plane is padded with that reflection and cropped again
+          for (int ch = 0; ch < 3; ++ch) {
+            cv::Mat plane, padded;
+            cv::extractChannel(gi[k], plane, ch);
+            cv::copyMakeBorder(plane, padded, 1, 1, 1, 1, cv::BORDER_REFLECT_101);
+            cv::medianBlur(padded, padded, 3);
+            cv::insertChannel(padded(cv::Rect(1, 1, plane.cols, plane.rows)), gi[k], ch);
+          }
+          // the network predicts the GI as RGB, GI2off takes it in the order OpenCV reads it
+          cv::cvtColor(gi[k], gi[k], cv::COLOR_RGB2BGR);
+          fs::path outModelFilePath = outPath.empty() ? batch[k].parent_path() : outPath;
+          Parameterization PM(LogSS, WS, batch[k], outModelFilePath, Flag);
+          WS.beginItem();
+          if (PM.GI2off(gi[k]))
+            ++own.nImages;
+          else {
+            ++own.nFailed;
+            Log.log(Logger::ERROR, batch[k].string(), "remesh", 0, LogSS.str());
+          }
+        }
+        std::chrono::high_resolution_clock::time_point t3 = std::chrono::high_resolution_clock::now();
+
+        own.load = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+        own.infer = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.0;
+        own.remesh = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / 1000.0;
+        Logger::metrics kv;
+        Logger::metric(kv, "load_ms", own.load);
+        Logger::metric(kv, "infer_ms", own.infer);
+        Logger::metric(kv, "remesh_ms", own.remesh);
+        Logger::metric(kv, "images", own.nImages);
+        std::stringstream tmpSS;
+        tmpSS << "batch " << b + 1 << "/" << nBatches << " : " << own.nImages << " meshes, load " << own.load
+            << " ms, infer " << own.infer << " ms, remesh " << own.remesh << " ms\n";
+        Log.log(Logger::INFO, Paths.listFilePath.string(), "batch", own.load + own.infer + own.remesh, tmpSS.str(), kv);
+        Log.progress(tmpSS.str(), b + 1 == nBatches);
+
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total.load += own.load;
+        total.infer += own.infer;
+        total.remesh += own.remesh;
+        total.nImages += own.nImages;
+        total.nBatches += own.nBatches;
+        total.nFailed += own.nFailed;
+      }
+    }));
+  }
+  for (std::size_t w = 0; w < workers.size(); ++w)
+    workers[w].join();
+  if (failedInit) {
+    Log.close();
+    return -1;
+  }
+
+  double sec = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-begin_main).count() / 1000.0;
+  std::stringstream tmpSS;
+  int n = std::max(1, total.nImages + total.nFailed);
+  int nb = std::max(1, total.nBatches);
+  tmpSS << total.nImages << " meshes, " << total.nFailed << " failed in " << sec << " sec, "
+      << (sec > 0 ? total.nImages / sec : 0) << " images/sec\n"
+      << "per image: load " << total.load / n << " ms, infer " << total.infer / n << " ms, remesh " << total.remesh / n << " ms\n"
+      << "per batch of " << batchSize << ": load " << total.load / nb << " ms, infer " << total.infer / nb << " ms, remesh " << total.remesh / nb << " ms\n";
+  std::cout << tmpSS.str();
+  Log.log(Logger::INFO, Paths.listFilePath.string(), "finish", sec * 1000, tmpSS.str());
+  Log.close();
+  std::cout << "Log written to " << logFilePath << std::endl;
+  return 0;
+}
+
+bool getFlags(char * argv[], int argc, fs::path& outPath, int& batchSize, int& nWorkers, int& nThreads) {
+  for (int i = 3; i < argc; ++i) {
+    if (argv[i] == std::string("--out"))
+      outPath = argv[++i];
+    else if (argv[i] == std::string("--batch"))
+      batchSize = std::max(1, atoi(argv[++i]));
+    else if (argv[i] == std::string("--workers"))
+      nWorkers = std::max(1, atoi(argv[++i]));
+    else if (argv[i] == std::string("--threads"))
+      nThreads = std::max(1, atoi(argv[++i]));
+    else if (argv[i] == std::string("--weld"))
+      Flag.weld = atof(argv[++i]);
+    else if (argv[i] == std::string("--mirror"))
+      Flag.mirror = true;
+    else  {
+      std::cerr << "Flag: " << argv[i] << " not defined in program\n";
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,81 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#include "Predictor.h"
+
+Predictor::Predictor(const tflite::FlatBufferModel& model, int batchSize, int nThreads):
+batchSize(batchSize), inSize(0), outSize(0) {
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  tflite::InterpreterBuilder(model, resolver)(&interpreter);
+  if (!interpreter) {
+    std::cerr << "Couldn't build the TFLite interpreter\n";
+    return;
+  }
+  interpreter->SetNumThreads(nThreads);
+
+  // the exported model takes NHWC float images, the batch dimension is set here
+  TfLiteTensor* in = interpreter->tensor(interpreter->inputs()[0]);
+  if (in->dims->size != 4 || in->dims->data[3] != 3 || in->type != kTfLiteFloat32) {
+    std::cerr << "Model input is not a float NHWC RGB image\n";
+    interpreter.reset();
+    return;
+  }
+  inSize = in->dims->data[1];
+  interpreter->ResizeInputTensor(interpreter->inputs()[0], { batchSize, inSize, inSize, 3 });
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    std::cerr << "Couldn't allocate the TFLite tensors for a batch of " << batchSize << "\n";
+    interpreter.reset();
+    return;
+  }
+  TfLiteTensor* out = interpreter->tensor(interpreter->outputs()[0]);
+  if (out->dims->size != 4 || out->dims->data[0] != batchSize || out->dims->data[3] != 3) {
+    std::cerr << "Model output is not a batch of 3 channel GIs\n";
+    interpreter.reset();
+    return;
+  }
+  outSize = out->dims->data[1];
+}
+
+Predictor::~Predictor() {
+  // TODO Auto-generated destructor stub
+}
+
+bool Predictor::preprocess(fs::path rgbFile, cv::Mat& rgb) const {
+  // as _parse_fn_img of python/data/dataset.py: RGB, scaled to [0,1], bilinear resize
+  cv::Mat img = cv::imread(rgbFile.string(), cv::IMREAD_COLOR);
+  if (img.empty())
+    return false;
+  cv::cvtColor(img, img, cv::COLOR_BGR2RGB);
+  img.convertTo(img, CV_32FC3, 1.0 / 255);
+  cv::resize(img, rgb, cv::Size(inSize, inSize), 0, 0, cv::INTER_LINEAR);
+  return true;
+}
+
+bool Predictor::predict(const std::vector<cv::Mat>& rgb, std::vector<cv::Mat>& gi) {
+  int n = rgb.size();
+  if (n == 0 || n > batchSize)
+    return false;
+
+  // a short last batch is padded with zeros
+  float* in = interpreter->typed_input_tensor<float>(0);
+  std::size_t inPixels = (std::size_t) inSize * inSize * 3;
+  for (int b = 0; b < n; ++b)
+    std::memcpy(in + b * inPixels, rgb[b].ptr<float>(), inPixels * sizeof(float));
+  std::fill(in + n * inPixels, in + batchSize * inPixels, 0.f);
+
+  if (interpreter->Invoke() != kTfLiteOk)
+    return false;
+
+  const float* out = interpreter->typed_output_tensor<float>(0);
+  std::size_t outPixels = (std::size_t) outSize * outSize * 3;
+  gi.resize(n);
+  for (int b = 0; b < n; ++b)
+    cv::Mat(outSize, outSize, CV_32FC3, const_cast<float*>(out + b * outPixels)).copyTo(gi[b]);
+  return true;
+}
@@ -0,0 +1,38 @@
+/***************************************************************************************
+ *    Title: Learning to Reconstruct Symmetric Shapes using Planar Parameterization of 3D Surface
+ *    Conference: IEEE International Conference on Computer Vision (ICCV) Workshops
+ *    Authors: Hardik Jain, Manuel Wöllhaf, Olaf Hellwich
+ *    Date: 7 Oct. 2019
+ *    Availability: https://github.com/hrdkjain/LearningSymmetricShapes
+ *
+ ***************************************************************************************/
+
+#ifndef PREDICTOR_H_
+#define PREDICTOR_H_
+
+#include "include.h"
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+
+// One TFLite interpreter of the exported autoencoder (python/converter/pb_to_tflite_converter.py)
+// sized for a batch of RGB images. An interpreter must not be shared between threads, each
+// worker owns its Predictor while the model buffer is shared.
+class Predictor {
+public:
+  Predictor(const tflite::FlatBufferModel& model, int batchSize, int nThreads);
+  virtual ~Predictor();
+  bool ok() const { return interpreter != nullptr; }
+  int inputSize() const { return inSize; }
+  bool preprocess(fs::path rgbFile, cv::Mat& rgb) const;
+  bool predict(const std::vector<cv::Mat>& rgb, std::vector<cv::Mat>& gi);
+
+private:
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  int batchSize;
+  int inSize; // rgb_size of the model
+  int outSize;  // gi_size of the model
+};
+
+#endif /* PREDICTOR_H_ */